@@ -5,7 +5,7 @@
 #include "LinearMath.h"
 
 namespace YAM{
-    class Random;
+    class Sampler;
 }
 
 namespace YAR{
@@ -26,7 +26,7 @@ namespace YAR{
               , resolutionY(resolutionY) {}
 
         virtual ~Camera() = default;
-        virtual YAM::Ray GetRay(uint32_t X, uint32_t Y, const YAM::Random& random) const = 0;
+        virtual YAM::Ray GetRay(uint32_t X, uint32_t Y, const YAM::Sampler& sampler) const = 0;
 
         uint32_t GetResolutionX() const { return resolutionX; }
         uint32_t GetResolutionY() const { return resolutionY; }
@@ -43,7 +43,7 @@ namespace YAR{
 
         ~OrthoCamera() override;
 
-        YAM::Ray GetRay(uint32_t x, uint32_t y, const YAM::Random& random) const override;
+        YAM::Ray GetRay(uint32_t x, uint32_t y, const YAM::Sampler& sampler) const override;
     };
 
     class PerspectiveCamera : public Camera {
@@ -72,7 +72,7 @@ namespace YAR{
 
         ~PerspectiveCamera() override;
 
-        YAM::Ray GetRay(uint32_t x, uint32_t y, const YAM::Random& random) const override;
+        YAM::Ray GetRay(uint32_t x, uint32_t y, const YAM::Sampler& sampler) const override;
 
     private:
         YAM::Vector3 GetScreenPosition() const;
@@ -1,28 +1,93 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
 #include <vector>
 
 #include "LinearMath.h"
+#include "Quantization.h"
 
 namespace YAM{
-    class Mat4;
+    template<typename T>
+    class Mat4T;
+
+    template<typename T>
+    class Mat3x4T;
+
+    using Mat4 = Mat4T<flt>;
+    using Mat3x4 = Mat3x4T<flt>;
 }
 
 namespace YAR {
 
+enum class MeshStorage {
+    Full,
+    // Positions quantized to 16 bits relative to the bounding box, octahedral normals
+    Compact
+};
+
+using TriangleIndices = YAM::TriangleIndices;
+
 class Mesh {
 private:
-    std::vector<YAM::Triangle> trianges;
-    
+    MeshStorage storage;
+
+    // Every vertex is an unique position and normal pair, shared between triangles
+    std::vector<YAM::Vector3> positions;
+    std::vector<YAM::Vector3> normals;
+    std::vector<TriangleIndices> indices;
+
+    std::vector<YAM::QuantizedPosition> compactPositions;
+    std::vector<uint32_t> compactNormals;
+    YAM::Vector3 dequantizeScale;
+
     YAM::AABB boudingBox;
-    
+
 public:
-    Mesh(const std::string& path);
+    Mesh(const std::string& path, bool weldVertices = false);
 
-    const std::vector<YAM::Triangle>& GetTriangles() const { return trianges; }
+    // Parses path face by face and hands the transformed triangles to onChunk, at most chunkSize
+    // at a time. Only the vertex and normal pools of the file are kept, never the whole mesh.
+    static void StreamTriangles(const std::string& path, const YAM::Mat4& transform, uint32_t chunkSize,
+                                const std::function<void(std::span<const YAM::Triangle>)>& onChunk);
+
+    const std::vector<TriangleIndices>& GetIndices() const { return indices; }
+    const std::vector<YAM::Vector3>& GetPositions() const { return positions; }
+    const std::vector<YAM::Vector3>& GetNormals() const { return normals; }
+    const std::vector<YAM::QuantizedPosition>& GetCompactPositions() const { return compactPositions; }
+    const std::vector<uint32_t>& GetCompactNormals() const { return compactNormals; }
     const YAM::AABB& GetBoudingBox() const { return boudingBox; }
-    
+
+    uint32_t GetTriangleCount() const { return static_cast<uint32_t>(indices.size()); }
+    uint32_t GetVertexCount() const {
+        return static_cast<uint32_t>(storage == MeshStorage::Full ? positions.size() : compactPositions.size());
+    }
+
+    MeshStorage GetStorage() const { return storage; }
+    void SetStorage(MeshStorage newStorage);
+
+    YAM::Vector3 DecodePosition(uint32_t vertexID) const {
+        return YAM::Quantization::DequantizePosition(compactPositions[vertexID], boudingBox.min, dequantizeScale);
+    }
+
+    YAM::Vector3 DecodeNormal(uint32_t vertexID) const {
+        return YAM::Quantization::DecodeNormal(compactNormals[vertexID]);
+    }
+
+    // Triangles in full precision, regardless of the storage mode
+    YAM::Triangle GetTriangle(uint32_t triangleID) const;
+    std::vector<YAM::Triangle> DecodeTriangles() const;
+    uint64_t GetGeometryBytes() const;
+
+    // Merges vertices whose positions and normals are both within tolerance of an earlier kept vertex.
+    // Vertices are compared to the kept one, not to each other, so chains of close vertices do not collapse.
+    void WeldVertices(YAM::flt tolerance = YAM::SmallFloat);
+
+    // The last row of mat has to be 0 0 0 1
     void Transform(const YAM::Mat4& mat);
+    void Transform(const YAM::Mat3x4& mat);
 private:
     void ParseOBJ(const std::string& path);
     void CalculateBoundingBox(const std::vector<YAM::Vector3>& verticies);
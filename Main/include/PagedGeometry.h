@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "LinearMath.h"
+
+namespace YAR{
+    struct GeometryBlock {
+        YAM::AABB bounds;
+        uint64_t offset;
+        uint32_t triangleCount;
+    };
+
+    struct PagingStats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t pageIns;
+        uint64_t evictions;
+        uint64_t residentBytes;
+        uint64_t peakResidentBytes;
+
+        float HitRate() const { return hits + misses == 0 ? 1.f : static_cast<float>(hits) / (hits + misses); }
+    };
+
+    // Resident copy of a block, hot positions and cold normals are kept apart
+    struct TriangleBlock {
+        std::vector<YAM::TrianglePositions> positions;
+        std::vector<YAM::TriangleNormals> normals;
+    };
+
+    // Out-of-core triangle storage. Leaf blocks live in a memory-mapped cache file
+    // and are copied into memory on demand. Once the resident budget is exceeded,
+    // blocks are evicted in clock order, which approximates least recently used.
+    // Hits on resident blocks take no lock, only page-ins and evictions do.
+    class PagedGeometryStore {
+    private:
+        struct ResidentEntry {
+            std::atomic<std::shared_ptr<const TriangleBlock>> triangles;
+            // Set by hits, cleared by the clock hand, blocks which have it get a second chance
+            std::atomic<bool> referenced{false};
+            // Per block, so hits from different threads rarely touch the same counter
+            std::atomic<uint64_t> hits{0};
+        };
+
+        std::string cachePath;
+        uint64_t residentBudget;
+
+        std::vector<GeometryBlock> blocks;
+        // Deque, so entries never move while blocks are added
+        std::deque<ResidentEntry> residentBlocks;
+        // Ids of resident blocks in the order the clock hand visits them
+        std::vector<uint32_t> clock;
+        size_t clockHand;
+
+        uint64_t fileSize;
+        const char* mappedFile;
+        uint64_t mappedSize;
+
+        uint64_t residentBytes;
+        uint64_t peakResidentBytes;
+        uint64_t misses;
+        uint64_t pageIns;
+        uint64_t evictions;
+
+        mutable std::mutex mutex;
+
+    public:
+        PagedGeometryStore(const std::string& cachePath, uint64_t residentBudget);
+        ~PagedGeometryStore();
+
+        PagedGeometryStore(const PagedGeometryStore&) = delete;
+        PagedGeometryStore& operator=(const PagedGeometryStore&) = delete;
+
+        // Splits triangles into spatially coherent blocks, writes them to the cache file
+        // and appends ids of created blocks to outBlockIds. Only an index per triangle is
+        // allocated, so large meshes can be added in chunks as they are parsed. Returns false when the
+        // cache file cannot be written, blocks written before the failure stay usable.
+        bool AddTriangles(std::span<const YAM::Triangle> triangles, uint32_t trianglesPerBlock,
+                          std::vector<uint32_t>& outBlockIds);
+
+        // Returned block stays valid even if it gets evicted while still in use.
+        // Blocks have to be added before the first Acquire.
+        std::shared_ptr<const TriangleBlock> Acquire(uint32_t blockId);
+
+        const GeometryBlock& GetBlock(uint32_t blockId) const { return blocks[blockId]; }
+        uint64_t GetResidentBudget() const { return residentBudget; }
+
+        PagingStats GetStats() const;
+        void LogStats() const;
+
+    private:
+        bool WriteBlock(std::span<const YAM::Triangle> triangles, const uint32_t* order, uint32_t count);
+        void MapFile();
+        void UnmapFile();
+
+        std::shared_ptr<const TriangleBlock> PageIn(uint32_t blockId);
+        void EvictUntilFits(uint64_t incomingBytes);
+    };
+} // YAR
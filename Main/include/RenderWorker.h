@@ -5,6 +5,10 @@
 #include "Renderer.h"
 #include "Vector3.h"
 
+namespace YAM{
+    class Sampler;
+}
+
 namespace YAR{
     class Camera;
 
@@ -12,14 +16,15 @@ namespace YAR{
         std::shared_ptr<Camera> camera;
         RenderBounds renderBounds;
 
-        YAM::Random random;
+        std::unique_ptr<YAM::Sampler> sampler;
 
         Renderer& owner;
     public:
         RenderWorker(Renderer& owner, const std::shared_ptr<Camera>& camera, const RenderBounds& renderBounds);
+        ~RenderWorker();
 
         void StartRender() const;
-        YAM::Vector3 SamplePixel(const Camera* camera, uint32_t y, uint32_t x) const;
+        YAM::Vector3 SamplePixel(const Camera* camera, uint32_t y, uint32_t x, uint32_t sampleID) const;
         bool CalculateRayCollision(const YAM::Ray& ray, RenderHitInfo& outHit) const;
     };
 } // YAR
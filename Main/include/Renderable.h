@@ -1,8 +1,27 @@
 #pragma once
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+
 #include "LinearMath.h"
+#include "Mat3x4.h"
+#include "Mat4.h"
 #include "Mesh.h"
+#include "PagedGeometry.h"
 
 namespace YAR{
+    // Direction picked at a surface by Material::Sample. Mirror and refraction lobes are delta
+    // lobes, they have no pdf over solid angle and light sampling can never find their direction.
+    struct MaterialSample {
+        YAM::Vector3 direction;
+        // Bsdf times cosine over pdf, what the ray color is multiplied by
+        YAM::Vector3 weight;
+        // Over solid angle, zero for delta lobes
+        YAM::flt pdf;
+        bool isDelta;
+    };
+
     struct Material {
         YAM::Color color;
         YAM::Color emisiveColor;
@@ -13,10 +32,32 @@ namespace YAR{
         float refractiveIndex;
 
         Material();
+
+        // Radiance leaving the front of an emitter
+        YAM::Vector3 GetEmittedLight() const { return emisiveColor.ToVector() * emmision; }
+        bool IsEmissive() const { return emmision > 0.f && emisiveColor.ToVector() != YAM::Vector3{0.f}; }
+
+        // Bsdf times cosine from incoming towards direction and the pdf of Sample picking it. Only the
+        // Lambertian lobe contributes, mirror and refraction are never hit by an arbitrary direction.
+        YAM::Vector3 Evaluate(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                              const YAM::Vector3& direction, YAM::flt& outPdf) const;
+        // lobeU picks diffuse, mirror or refraction as often as each weighs, u and v the diffuse direction
+        MaterialSample Sample(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                              YAM::flt lobeU, YAM::flt u, YAM::flt v) const;
+
+    private:
+        // Refraction gets the rest, glass refracts less at grazing angles
+        void GetLobeChances(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                            float& outDiffuse, float& outSpecular) const;
     };
 
     struct RenderHitInfo : public YAM::HitInfo {
-        const Material* material;
+        // Index into materials of the committed Scene
+        uint32_t materialID;
+        // Index into lights of the committed Scene, NoLight unless an explicitly sampled emitter was hit
+        uint32_t lightID;
+
+        static constexpr uint32_t NoLight = std::numeric_limits<uint32_t>::max();
 
         RenderHitInfo();
 
@@ -24,7 +65,8 @@ namespace YAR{
             hitPoint = hitInfo.hitPoint;
             normal = hitInfo.normal;
             distance = hitInfo.distance;
-            material = hitInfo.material;
+            materialID = hitInfo.materialID;
+            lightID = hitInfo.lightID;
             
             return *this;
         }
@@ -34,13 +76,13 @@ namespace YAR{
     private:
         Material material;
 
-    protected:
-        Material& GetMaterial() { return material; }
-
     public:
         explicit Renderable(const Material& material);
         virtual ~Renderable() = 0;
 
+        const Material& GetMaterial() const { return material; }
+
+        // Fills geometric part of hitInfo, material is resolved by the Scene
         virtual bool Trace(const YAM::Ray& ray, RenderHitInfo& hitInfo) = 0;
     };
 
@@ -53,18 +95,68 @@ namespace YAR{
         ~SphereRenderable() override;
 
         bool Trace(const YAM::Ray& ray, RenderHitInfo& hitInfo) override;
+
+        const YAM::Sphere& GetSphere() const { return sphere; }
     };
 
     class MeshRenderable : public Renderable {
     private:
-        Mesh mesh;
+        std::unique_ptr<Mesh> mesh;
+
+        // Proxy mode: the mesh is parsed on the first ray that enters proxyBounds
+        std::string objPath;
+        YAM::AABB proxyBounds;
+        YAM::Mat3x4 pendingTransform;
+        MeshStorage pendingStorage;
+        std::once_flag loadFlag;
+        std::atomic<bool> loaded;
 
     public:
         MeshRenderable(const Material& material, const std::string& objPath);
+        MeshRenderable(const Material& material, const std::string& objPath, const YAM::AABB& proxyBounds);
         ~MeshRenderable() override;
 
         bool Trace(const YAM::Ray& ray, RenderHitInfo& outHit) override;
 
         void Transform(const YAM::Mat4& mat4);
+        void SetStorage(MeshStorage storage);
+
+        bool IsLoaded() const { return loaded.load(std::memory_order_acquire); }
+        const Mesh* GetMesh() const { return IsLoaded() ? mesh.get() : nullptr; }
+
+    private:
+        void Load();
+    };
+
+    // Mesh which keeps its triangles in a PagedGeometryStore instead of memory
+    class PagedMeshRenderable : public Renderable {
+    private:
+        std::shared_ptr<PagedGeometryStore> store;
+        std::vector<uint32_t> blockIds;
+        std::vector<YAM::AABB> blockBounds;
+
+        YAM::AABB boundingBox;
+
+    public:
+        static constexpr uint32_t DefaultTrianglesPerBlock = 256;
+        // Block bounds culled per kernel call
+        static constexpr uint32_t BoundsBatchSize = 64;
+        // Triangles handed to the store at once, blocks never span two chunks
+        static constexpr uint32_t StreamChunkSize = 1 << 16;
+
+        // Streams the triangles of the file into store, the mesh is never held in memory whole
+        PagedMeshRenderable(const Material& material, const std::string& objPath, const YAM::Mat4& transform,
+                            const std::shared_ptr<PagedGeometryStore>& store,
+                            uint32_t trianglesPerBlock = DefaultTrianglesPerBlock);
+        // Copies an already loaded mesh into store, chunk by chunk
+        PagedMeshRenderable(const Material& material, const Mesh& mesh,
+                            const std::shared_ptr<PagedGeometryStore>& store,
+                            uint32_t trianglesPerBlock = DefaultTrianglesPerBlock);
+        ~PagedMeshRenderable() override;
+
+        bool Trace(const YAM::Ray& ray, RenderHitInfo& outHit) override;
+
+    private:
+        void AddChunk(std::span<const YAM::Triangle> triangles, uint32_t trianglesPerBlock);
     };
 }
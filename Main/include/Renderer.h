@@ -5,6 +5,7 @@
 #include <mutex>
 #include <vector>
 
+#include "Scene.h"
 #include "Vector3.h"
 
 namespace YAR{
@@ -13,6 +14,7 @@ namespace YAR{
 
 namespace YAM{
     struct Ray;
+    class Sampler;
 }
 
 namespace YAR{
@@ -36,21 +38,29 @@ namespace YAR{
         mutable std::mutex colorBufferMutex;
         mutable std::mutex fileIOMutex;
 
-        std::vector<std::shared_ptr<Renderable>> renderables;
+        Scene scene;
 
         uint32_t samplesPerPixel;
         uint32_t maxBounces;
         uint32_t tilesPerRow;
 
+        // Prototype every render worker clones its own sampler from
+        std::shared_ptr<YAM::Sampler> sampler;
 
         std::shared_ptr<Camera> camera;
 
     public:
+        // Seed of every render, sample streams are told apart by pixel, sample and dimension
+        static constexpr uint32_t RenderSeed = 195487;
+
         Renderer(uint32_t sizeX, uint32_t sizeY, uint32_t samplesPerPixel, uint32_t maxBounces, uint32_t tilesPerRow);
         ~Renderer();
 
         void AddRenderable(const std::shared_ptr<Renderable>& renderable);
 
+        Scene& GetScene() { return scene; }
+        const Scene& GetScene() const { return scene; }
+
         void Render(const std::shared_ptr<YAR::Camera> camera);
         void Save(const std::string& path) const;
 
@@ -58,6 +68,10 @@ namespace YAR{
         uint32_t GetMaxBounces() const { return maxBounces; }
         uint32_t GetTilesPerRow() const { return tilesPerRow; }
 
+        // Owen scrambled Sobol by default
+        void SetSampler(const std::shared_ptr<YAM::Sampler>& sampler) { this->sampler = sampler; }
+        const YAM::Sampler& GetSampler() const { return *sampler; }
+
         friend class RenderWorker;
     };
 } // SG
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AliasTable.h"
+#include "LinearMath.h"
+#include "Mesh.h"
+#include "Renderable.h"
+
+namespace YAR{
+    struct SceneSphere {
+        YAM::Sphere sphere;
+        uint32_t materialID;
+        uint32_t lightID;
+    };
+
+    // Bounds are kept apart in Scene::meshBounds, so they can be culled in one batch
+    struct SceneMesh {
+        uint32_t firstTriangle;
+        uint32_t triangleCount;
+        uint32_t materialID;
+        // Emissive meshes own one light per triangle starting here, others keep NoLight
+        uint32_t firstLight;
+    };
+
+    // Anything which could not be flattened, traced through virtual Renderable::Trace
+    struct SceneRenderable {
+        Renderable* renderable;
+        uint32_t materialID;
+    };
+
+    enum class LightShape : uint8_t {
+        Triangle,
+        Sphere
+    };
+
+    // Emissive primitive of a flattened sphere or mesh, primitive indexes Scene::spheres or Scene::triangles
+    struct SceneLight {
+        LightShape shape;
+        uint32_t primitive;
+        uint32_t materialID;
+        YAM::flt area;
+    };
+
+    // Point on a light as seen from a shaded point. The pdf is over solid angle at that point
+    // and already includes picking the light.
+    struct LightSample {
+        YAM::Vector3 direction;
+        YAM::flt distance;
+        YAM::Vector3 radiance;
+        YAM::flt pdf;
+    };
+
+    // Owns renderables. Commit() freezes them into flat read-only arrays, one per
+    // primitive type, which are traced without reference counting or virtual calls.
+    class Scene {
+    private:
+        std::vector<std::shared_ptr<Renderable>> renderables;
+        bool committed;
+
+        std::vector<Material> materials;
+
+        std::vector<SceneSphere> spheres;
+        std::vector<SceneMesh> meshes;
+        std::vector<YAM::AABB> meshBounds;
+        std::vector<SceneRenderable> customRenderables;
+
+        // Emitters which can be sampled directly, picked proportionally to area times power
+        std::vector<SceneLight> lights;
+        YAM::AliasTable lightTable;
+
+        // Vertices of all flattened meshes in world space, indices are global
+        std::vector<YAM::Vector3> positions;
+        std::vector<YAM::Vector3> normals;
+        std::vector<TriangleIndices> triangles;
+
+    public:
+        Scene();
+        ~Scene();
+
+        void AddRenderable(const std::shared_ptr<Renderable>& renderable);
+
+        void Commit();
+        bool IsCommitted() const { return committed; }
+
+        bool Trace(const YAM::Ray& ray, RenderHitInfo& outHit) const;
+        // Anything closer than maxDistance along the ray
+        bool IsOccluded(const YAM::Ray& ray, YAM::flt maxDistance) const;
+
+        // Picks a light with lightU and a point on it with u, v. Fails without lights or when the
+        // point faces away from point.
+        bool SampleLight(const YAM::Vector3& point, YAM::flt lightU, YAM::flt u, YAM::flt v,
+                         LightSample& outSample) const;
+        // Pdf over solid angle with which SampleLight from point returns lightPoint on light lightID
+        YAM::flt GetLightPdf(uint32_t lightID, const YAM::Vector3& point, const YAM::Vector3& lightPoint) const;
+        bool HasLights() const { return !lightTable.IsEmpty(); }
+
+        const Material& GetMaterial(uint32_t materialID) const { return materials[materialID]; }
+
+    private:
+        void Clear();
+
+        void FlattenSphere(const SphereRenderable& sphere, uint32_t materialID);
+        void FlattenMesh(const Mesh& mesh, uint32_t materialID);
+        void BuildLights();
+        YAM::Vector3 GetLightNormal(const SceneLight& light, const YAM::Vector3& lightPoint) const;
+
+        bool TraceClosest(const YAM::Ray& ray, RenderHitInfo& inOutHit) const;
+
+        bool TraceMeshes(const YAM::TraversalRay& ray, RenderHitInfo& outHit) const;
+
+        template<typename Primitive>
+        bool TraceAll(const YAM::Ray& ray, const std::vector<Primitive>& primitives, RenderHitInfo& outHit) const;
+
+        bool TracePrimitive(const YAM::Ray& ray, const SceneSphere& sphere, RenderHitInfo& outHit) const;
+        bool TracePrimitive(const YAM::Ray& ray, const SceneMesh& mesh, RenderHitInfo& outHit) const;
+        bool TracePrimitive(const YAM::Ray& ray, const SceneRenderable& renderable, RenderHitInfo& outHit) const;
+    };
+} // YAR
@@ -1,6 +1,6 @@
 #include "Camera.h"
 
-#include "Algorithms.h"
+#include "Sampler.h"
 
 namespace YAR{
     using namespace YAM;
@@ -13,7 +13,7 @@ namespace YAR{
 
     OrthoCamera::~OrthoCamera() {};
 
-    Ray OrthoCamera::GetRay(uint32_t x, uint32_t y, const YAM::Random& random) const {
+    Ray OrthoCamera::GetRay(uint32_t x, uint32_t y, const YAM::Sampler& sampler) const {
         const flt stepX = orthoSizeX / resolutionX;
         const flt stepY = orthoSizeY / resolutionY;
 
@@ -27,7 +27,7 @@ namespace YAR{
             + (screenUp * (orthoSizeY * 0.5f));
         
         flt jitterX, jitterY;
-        random.RandomPointInCircle(jitterX, jitterY);
+        sampler.GetDisk(jitterX, jitterY);
         constexpr flt jitterStrenth = 0.5f;
 
         Vector3 screenOffset = (stepX * screenRight * (static_cast<flt>(x) + jitterX * jitterStrenth))
@@ -60,9 +60,9 @@ namespace YAR{
 
     PerspectiveCamera::~PerspectiveCamera() = default;
 
-    Ray PerspectiveCamera::GetRay(uint32_t x, uint32_t y, const YAM::Random& random) const {
+    Ray PerspectiveCamera::GetRay(uint32_t x, uint32_t y, const YAM::Sampler& sampler) const {
         flt jitterX, jitterY;
-        random.RandomPointInCircle(jitterX, jitterY);
+        sampler.GetDisk(jitterX, jitterY);
         constexpr flt jitterStrenth = 1.5f;
         jitterX *= jitterStrenth;
         jitterY *= jitterStrenth;
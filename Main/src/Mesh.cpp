@@ -1,16 +1,135 @@
 #include "Mesh.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <unordered_map>
 #include <spdlog/spdlog.h>
 
 #include "Vector4.h"
 #include "Vector3.h"
+#include "Mat3x4.h"
 #include "Mat4.h"
 
 namespace YAR{
-    Mesh::Mesh(const std::string& path) {
+    namespace {
+        constexpr uint32_t TransformBatchSize = 16;
+        constexpr size_t ParallelTransformThreshold = 1 << 14;
+
+        // Transforms vectors in place, returns exact bounds of the results. Vectors are
+        // gathered into SoA batches so the arithmetic vectorizes, large arrays are
+        // split between threads.
+        YAM::AABB TransformBatched(std::vector<YAM::Vector3>& vectors, const YAM::Mat3x4& m) {
+            const int64_t batchCount = static_cast<int64_t>((vectors.size() + TransformBatchSize - 1) / TransformBatchSize);
+
+            YAM::flt minX = std::numeric_limits<YAM::flt>::max();
+            YAM::flt minY = std::numeric_limits<YAM::flt>::max();
+            YAM::flt minZ = std::numeric_limits<YAM::flt>::max();
+            YAM::flt maxX = std::numeric_limits<YAM::flt>::lowest();
+            YAM::flt maxY = std::numeric_limits<YAM::flt>::lowest();
+            YAM::flt maxZ = std::numeric_limits<YAM::flt>::lowest();
+
+#pragma omp parallel for if(vectors.size() >= ParallelTransformThreshold) \
+    reduction(min: minX, minY, minZ) reduction(max: maxX, maxY, maxZ)
+            for (int64_t batchID = 0; batchID < batchCount; ++batchID) {
+                const size_t first = batchID * TransformBatchSize;
+                const uint32_t count = static_cast<uint32_t>(std::min<size_t>(TransformBatchSize, vectors.size() - first));
+
+                alignas(64) YAM::flt x[TransformBatchSize] = {};
+                alignas(64) YAM::flt y[TransformBatchSize] = {};
+                alignas(64) YAM::flt z[TransformBatchSize] = {};
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    x[i] = vectors[first + i].x;
+                    y[i] = vectors[first + i].y;
+                    z[i] = vectors[first + i].z;
+                }
+
+                alignas(64) YAM::flt outX[TransformBatchSize];
+                alignas(64) YAM::flt outY[TransformBatchSize];
+                alignas(64) YAM::flt outZ[TransformBatchSize];
+
+#pragma omp simd
+                for (uint32_t i = 0; i < TransformBatchSize; ++i) {
+                    outX[i] = m[0][0] * x[i] + m[0][1] * y[i] + m[0][2] * z[i] + m[0][3];
+                    outY[i] = m[1][0] * x[i] + m[1][1] * y[i] + m[1][2] * z[i] + m[1][3];
+                    outZ[i] = m[2][0] * x[i] + m[2][1] * y[i] + m[2][2] * z[i] + m[2][3];
+                }
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    vectors[first + i] = YAM::Vector3{outX[i], outY[i], outZ[i]};
+
+                    minX = std::min(minX, outX[i]);
+                    minY = std::min(minY, outY[i]);
+                    minZ = std::min(minZ, outZ[i]);
+                    maxX = std::max(maxX, outX[i]);
+                    maxY = std::max(maxY, outY[i]);
+                    maxZ = std::max(maxZ, outZ[i]);
+                }
+            }
+
+            YAM::AABB bounds;
+            bounds.min = YAM::Vector3{minX, minY, minZ};
+            bounds.max = YAM::Vector3{maxX, maxY, maxZ};
+
+            return bounds;
+        }
+
+        enum class OBJCommand {
+            Other,
+            Vertex,
+            Normal,
+            Face
+        };
+
+        // One line of an OBJ file. Faces have to be triangles in v/t/n form, their indices stay 1 based.
+        OBJCommand ParseOBJLine(const std::string& fileLine, YAM::Vector3& outVector,
+                                std::array<uint32_t, 3>& outVertexIDs, std::array<uint32_t, 3>& outNormalIDs) {
+            // skip comments and empty lines
+            if (fileLine.empty() || fileLine[0] == '#') {
+                return OBJCommand::Other;
+            }
+
+            // Parameters are read in place, long face lines do not fit any fixed buffer
+            char command[3];
+            int parametersOffset = 0;
+            if (std::sscanf(fileLine.c_str(), "%2s%n", command, &parametersOffset) != 1) {
+                return OBJCommand::Other;
+            }
+            const char* parameters = fileLine.c_str() + parametersOffset;
+
+            // Read as float whatever YAM::flt is, sscanf has no type checking
+            float x = 0.f, y = 0.f, z = 0.f;
+            if (strcmp(command, "v") == 0 || strcmp(command, "vn") == 0) {
+                std::sscanf(parameters, "%f %f %f", &x, &y, &z);
+                outVector = YAM::Vector3{x, y, z};
+                return command[1] == 'n' ? OBJCommand::Normal : OBJCommand::Vertex;
+            }
+            if (strcmp(command, "f") == 0) {
+                uint32_t t1, t2, t3;
+
+                std::sscanf(parameters,
+                           "%u/%u/%u %u/%u/%u %u/%u/%u",
+                           &outVertexIDs[0], &t1, &outNormalIDs[0],
+                           &outVertexIDs[1], &t2, &outNormalIDs[1],
+                           &outVertexIDs[2], &t3, &outNormalIDs[2]);
+                return OBJCommand::Face;
+            }
+
+            return OBJCommand::Other;
+        }
+    }
+
+    Mesh::Mesh(const std::string& path, bool weldVertices)
+        : storage(MeshStorage::Full) {
         ParseOBJ(path);
+
+        if (weldVertices) {
+            WeldVertices();
+        }
     }
 
     void Mesh::ParseOBJ(const std::string& path) {
@@ -19,75 +138,117 @@ namespace YAR{
         std::vector<YAM::Vector3> verticies{};
         std::vector<uint32_t> vert_indicies{};
         
-        std::vector<YAM::Vector3> normals{};
+        std::vector<YAM::Vector3> objNormals{};
         std::vector<uint32_t> norm_indicies{};
 
         // Parse file
         std::string fileLine;
         while (std::getline(objFile, fileLine)) {
-            
-            // skip comments
-            if (fileLine[0] == '#') {
-                continue;
-            }
-
-            char command[3];
-            char parameters[30];
-
-            std::sscanf(fileLine.c_str(), "%s %[^\t\n]", command, parameters);
-            
-            if (strcmp(command, "v") == 0) {
-                YAM::Vector3 vertex;
-                std::sscanf(parameters, "%f %f %f", &vertex.x, &vertex.y, &vertex.z);
-                verticies.push_back(vertex);
-            }
-            if (strcmp(command, "vn") == 0) {
-                YAM::Vector3 normal;
-                std::sscanf(parameters, "%f %f %f", &normal.x, &normal.y, &normal.z);
-                normals.push_back(normal);
-            }
-            if (strcmp(command, "f") == 0) {
-                uint32_t v1, v2, v3;
-                uint32_t t1, t2, t3;
-                uint32_t n1, n2, n3;
+            YAM::Vector3 vector;
+            std::array<uint32_t, 3> vertexIDs, normalIDs;
 
-                std::sscanf(parameters,
-                           "%i/%i/%i %i/%i/%i %i/%i/%i",
-                           &v1, &t1, &n1, &v2, &t2, &n2, &v3, &t3, &n3);
-
-                vert_indicies.push_back(v1);
-                vert_indicies.push_back(v2);
-                vert_indicies.push_back(v3);
-                
-                norm_indicies.push_back(n1);
-                norm_indicies.push_back(n2);
-                norm_indicies.push_back(n3);
+            switch (ParseOBJLine(fileLine, vector, vertexIDs, normalIDs)) {
+                case OBJCommand::Vertex:
+                    verticies.push_back(vector);
+                    break;
+                case OBJCommand::Normal:
+                    objNormals.push_back(vector);
+                    break;
+                case OBJCommand::Face:
+                    vert_indicies.insert(vert_indicies.end(), vertexIDs.begin(), vertexIDs.end());
+                    norm_indicies.insert(norm_indicies.end(), normalIDs.begin(), normalIDs.end());
+                    break;
+                default:
+                    break;
             }
         }
 
-        // create triangles
+        // create indexed triangles, one vertex per unique position and normal pair
         spdlog::info("{} {}", vert_indicies.size(), norm_indicies.size());
+
+        std::unordered_map<uint64_t, uint32_t> vertexLookup{};
+        const auto findOrAddVertex = [&](uint32_t vertexID, uint32_t normalID) {
+            const uint64_t key = static_cast<uint64_t>(vertexID) << 32 | normalID;
+
+            const auto [it, inserted] = vertexLookup.try_emplace(key, static_cast<uint32_t>(positions.size()));
+            if (inserted) {
+                positions.push_back(verticies[vertexID]);
+                normals.push_back(objNormals[normalID]);
+            }
+
+            return it->second;
+        };
         
         for (int triangleID = 0; triangleID < std::trunc(vert_indicies.size() / 3); ++triangleID) {
             uint32_t indiceID = triangleID * 3;
-            
-            const uint32_t v1 = vert_indicies[indiceID] - 1;
-            const uint32_t v2 = vert_indicies[indiceID + 1] - 1;
-            const uint32_t v3 = vert_indicies[indiceID + 2] - 1;
-            
-            const uint32_t n1 = norm_indicies[indiceID] - 1;
-            const uint32_t n2 = norm_indicies[indiceID + 1] - 1;
-            const uint32_t n3 = norm_indicies[indiceID + 2] - 1;
-
-            trianges.emplace_back(
-                verticies[v1],verticies[v2],verticies[v3],
-                normals[n1],normals[n2],normals[n3]
-                );
+
+            TriangleIndices triangle{};
+            triangle.a = findOrAddVertex(vert_indicies[indiceID] - 1, norm_indicies[indiceID] - 1);
+            triangle.b = findOrAddVertex(vert_indicies[indiceID + 1] - 1, norm_indicies[indiceID + 1] - 1);
+            triangle.c = findOrAddVertex(vert_indicies[indiceID + 2] - 1, norm_indicies[indiceID + 2] - 1);
+
+            indices.push_back(triangle);
         }
         
         CalculateBoundingBox(verticies);
     }
 
+    void Mesh::StreamTriangles(const std::string& path, const YAM::Mat4& transform, uint32_t chunkSize,
+                               const std::function<void(std::span<const YAM::Triangle>)>& onChunk) {
+        std::ifstream objFile{path};
+        if (!objFile) {
+            spdlog::error("Cannot open mesh {}", path);
+            return;
+        }
+
+        const YAM::Mat3x4 pointMatrix(transform);
+        const YAM::Mat3x4 normalMatrix = pointMatrix.NormalMatrix();
+
+        std::vector<YAM::Vector3> verticies{};
+        std::vector<YAM::Vector3> objNormals{};
+
+        std::vector<YAM::Triangle> chunk{};
+        chunk.reserve(std::max(chunkSize, 1u));
+
+        uint64_t triangleCount = 0;
+        std::string fileLine;
+        while (std::getline(objFile, fileLine)) {
+            YAM::Vector3 vector;
+            std::array<uint32_t, 3> vertexIDs, normalIDs;
+
+            switch (ParseOBJLine(fileLine, vector, vertexIDs, normalIDs)) {
+                case OBJCommand::Vertex:
+                    verticies.push_back(pointMatrix.TransformPoint(vector));
+                    break;
+                case OBJCommand::Normal:
+                    // Renormalized after interpolation, like Transform does
+                    objNormals.push_back(normalMatrix.TransformVector(vector));
+                    break;
+                case OBJCommand::Face:
+                    chunk.push_back({
+                        verticies[vertexIDs[0] - 1], verticies[vertexIDs[1] - 1], verticies[vertexIDs[2] - 1],
+                        objNormals[normalIDs[0] - 1], objNormals[normalIDs[1] - 1], objNormals[normalIDs[2] - 1]
+                    });
+
+                    if (chunk.size() >= chunkSize) {
+                        onChunk(chunk);
+                        triangleCount += chunk.size();
+                        chunk.clear();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (!chunk.empty()) {
+            onChunk(chunk);
+            triangleCount += chunk.size();
+        }
+
+        spdlog::info("Streamed {} triangles from {}", triangleCount, path);
+    }
+
     void Mesh::CalculateBoundingBox(const std::vector<YAM::Vector3>& verticies) {
         for (const YAM::Vector3& vertex : verticies) {
             boudingBox.min.x = std::min(boudingBox.min.x, vertex.x);
@@ -100,20 +261,177 @@ namespace YAR{
         }
     }
 
+    void Mesh::SetStorage(MeshStorage newStorage) {
+        if (newStorage == storage) {
+            return;
+        }
+
+        if (newStorage == MeshStorage::Full) {
+            positions.reserve(compactPositions.size());
+            normals.reserve(compactNormals.size());
+            for (uint32_t vertexID = 0; vertexID < compactPositions.size(); ++vertexID) {
+                positions.push_back(DecodePosition(vertexID));
+                normals.push_back(DecodeNormal(vertexID));
+            }
+
+            compactPositions.clear();
+            compactPositions.shrink_to_fit();
+            compactNormals.clear();
+            compactNormals.shrink_to_fit();
+        }
+        else {
+            // Quantization needs bounds which contain every vertex
+            boudingBox = YAM::AABB();
+            CalculateBoundingBox(positions);
+            dequantizeScale = YAM::Quantization::DequantizeScale(boudingBox);
+
+            compactPositions.reserve(positions.size());
+            compactNormals.reserve(normals.size());
+            for (uint32_t vertexID = 0; vertexID < positions.size(); ++vertexID) {
+                compactPositions.push_back(YAM::Quantization::QuantizePosition(positions[vertexID], boudingBox));
+                compactNormals.push_back(YAM::Quantization::EncodeNormal(normals[vertexID]));
+            }
+
+            positions.clear();
+            positions.shrink_to_fit();
+            normals.clear();
+            normals.shrink_to_fit();
+        }
+
+        storage = newStorage;
+    }
+
+    YAM::Triangle Mesh::GetTriangle(uint32_t triangleID) const {
+        const TriangleIndices& triangle = indices[triangleID];
+
+        if (storage == MeshStorage::Full) {
+            return {
+                positions[triangle.a], positions[triangle.b], positions[triangle.c],
+                normals[triangle.a], normals[triangle.b], normals[triangle.c]
+            };
+        }
+
+        return {
+            DecodePosition(triangle.a), DecodePosition(triangle.b), DecodePosition(triangle.c),
+            DecodeNormal(triangle.a), DecodeNormal(triangle.b), DecodeNormal(triangle.c)
+        };
+    }
+
+    std::vector<YAM::Triangle> Mesh::DecodeTriangles() const {
+        std::vector<YAM::Triangle> result;
+        result.reserve(indices.size());
+        for (uint32_t triangleID = 0; triangleID < indices.size(); ++triangleID) {
+            result.push_back(GetTriangle(triangleID));
+        }
+
+        return result;
+    }
+
+    uint64_t Mesh::GetGeometryBytes() const {
+        return positions.size() * sizeof(YAM::Vector3) + normals.size() * sizeof(YAM::Vector3)
+            + compactPositions.size() * sizeof(YAM::QuantizedPosition) + compactNormals.size() * sizeof(uint32_t)
+            + indices.size() * sizeof(TriangleIndices);
+    }
+
+    void Mesh::WeldVertices(YAM::flt tolerance) {
+        const MeshStorage originalStorage = storage;
+        SetStorage(MeshStorage::Full);
+
+        // Cells are tolerance wide, so every candidate lies in the cell of the vertex or one next to it
+        const auto snap = [tolerance](YAM::flt value) {
+            return static_cast<int64_t>(std::floor(value / tolerance));
+        };
+
+        // 21 bits per axis. Far cells can share a key, which only costs extra distance checks.
+        const auto cellKey = [](int64_t x, int64_t y, int64_t z) {
+            constexpr uint64_t mask = (1u << 21) - 1;
+            return (static_cast<uint64_t>(x) & mask) << 42 | (static_cast<uint64_t>(y) & mask) << 21
+                | (static_cast<uint64_t>(z) & mask);
+        };
+
+        const YAM::flt toleranceSquared = tolerance * tolerance;
+
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cellLookup{};
+        std::vector<uint32_t> remap(positions.size());
+
+        std::vector<YAM::Vector3> weldedPositions{};
+        std::vector<YAM::Vector3> weldedNormals{};
+        // Normalized, normals are compared by direction
+        std::vector<YAM::Vector3> weldedDirections{};
+
+        for (uint32_t vertexID = 0; vertexID < positions.size(); ++vertexID) {
+            const YAM::Vector3& position = positions[vertexID];
+            const YAM::Vector3 normal = normals[vertexID].Normal();
+
+            const int64_t cellX = snap(position.x);
+            const int64_t cellY = snap(position.y);
+            const int64_t cellZ = snap(position.z);
+
+            // Merged into the first welded vertex closer than tolerance in position and in normal
+            uint32_t weldedID = std::numeric_limits<uint32_t>::max();
+            for (int64_t x = cellX - 1; x <= cellX + 1 && weldedID == std::numeric_limits<uint32_t>::max(); ++x) {
+                for (int64_t y = cellY - 1; y <= cellY + 1 && weldedID == std::numeric_limits<uint32_t>::max(); ++y) {
+                    for (int64_t z = cellZ - 1; z <= cellZ + 1; ++z) {
+                        const auto cell = cellLookup.find(cellKey(x, y, z));
+                        if (cell == cellLookup.end()) {
+                            continue;
+                        }
+
+                        const auto candidate = std::find_if(cell->second.begin(), cell->second.end(), [&](uint32_t id) {
+                            const YAM::Vector3 positionOffset = weldedPositions[id] - position;
+                            const YAM::Vector3 normalOffset = weldedDirections[id] - normal;
+                            return positionOffset.Dot(positionOffset) <= toleranceSquared
+                                && normalOffset.Dot(normalOffset) <= toleranceSquared;
+                        });
+
+                        if (candidate != cell->second.end()) {
+                            weldedID = *candidate;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (weldedID == std::numeric_limits<uint32_t>::max()) {
+                weldedID = static_cast<uint32_t>(weldedPositions.size());
+                weldedPositions.push_back(position);
+                weldedNormals.push_back(normals[vertexID]);
+                weldedDirections.push_back(normal);
+                cellLookup[cellKey(cellX, cellY, cellZ)].push_back(weldedID);
+            }
+
+            remap[vertexID] = weldedID;
+        }
+
+        for (TriangleIndices& triangle : indices) {
+            triangle.a = remap[triangle.a];
+            triangle.b = remap[triangle.b];
+            triangle.c = remap[triangle.c];
+        }
+
+        spdlog::info("Welded {} vertices into {}", positions.size(), weldedPositions.size());
+
+        positions = std::move(weldedPositions);
+        normals = std::move(weldedNormals);
+
+        SetStorage(originalStorage);
+    }
+
     void Mesh::Transform(const YAM::Mat4& mat) {
-        const YAM::Mat4 normalTranslation = mat.ClearTranslation().Inverse().Transpose();
-        
-        for (YAM::Triangle& triange : trianges) {
-            triange.posA = YAM::Vector3(mat * YAM::Vector4(triange.posA, 1.f));
-            triange.posB = YAM::Vector3(mat * YAM::Vector4(triange.posB, 1.f));
-            triange.posC = YAM::Vector3(mat * YAM::Vector4(triange.posC, 1.f));
-            
-            triange.norA = YAM::Vector3(normalTranslation * YAM::Vector4(triange.norA, 1.f));
-            triange.norB = YAM::Vector3(normalTranslation * YAM::Vector4(triange.norB, 1.f));
-            triange.norC = YAM::Vector3(normalTranslation * YAM::Vector4(triange.norC, 1.f));
-        }
-
-        boudingBox.min = YAM::Vector3(mat * YAM::Vector4(boudingBox.min, 1.f));
-        boudingBox.max = YAM::Vector3(mat * YAM::Vector4(boudingBox.max, 1.f));
+        Transform(YAM::Mat3x4(mat));
+    }
+
+    void Mesh::Transform(const YAM::Mat3x4& mat) {
+        if (storage == MeshStorage::Compact) {
+            // Requantize against the transformed bounds
+            SetStorage(MeshStorage::Full);
+            Transform(mat);
+            SetStorage(MeshStorage::Compact);
+            return;
+        }
+
+        boudingBox = TransformBatched(positions, mat);
+        // Normals are renormalized after interpolation, so the scale of NormalMatrix() does not matter
+        TransformBatched(normals, mat.NormalMatrix());
     }
 } // YAR
@@ -0,0 +1,335 @@
+#include "PagedGeometry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace YAR{
+    namespace {
+        // Three positions or three normals
+        constexpr uint32_t FloatsPerAttribute = 9;
+        constexpr uint32_t FloatsPerTriangle = 2 * FloatsPerAttribute;
+        constexpr uint64_t BytesPerTriangle = FloatsPerTriangle * sizeof(float);
+        constexpr uint64_t BytesPerResidentTriangle = sizeof(YAM::TrianglePositions) + sizeof(YAM::TriangleNormals);
+
+        YAM::Vector3 Centroid(const YAM::Triangle& triangle) {
+            return (triangle.posA + triangle.posB + triangle.posC) / 3.f;
+        }
+
+        void ExpandBounds(YAM::AABB& bounds, const YAM::Vector3& point) {
+            bounds.min.x = std::min(bounds.min.x, point.x);
+            bounds.min.y = std::min(bounds.min.y, point.y);
+            bounds.min.z = std::min(bounds.min.z, point.z);
+
+            bounds.max.x = std::max(bounds.max.x, point.x);
+            bounds.max.y = std::max(bounds.max.y, point.y);
+            bounds.max.z = std::max(bounds.max.z, point.z);
+        }
+
+        // Median split on the widest centroid axis, until ranges fit into a single block.
+        // Reorders the triangle indices in order, the triangles themselves stay where they are.
+        void SplitIntoBlocks(std::span<const YAM::Triangle> triangles, std::vector<uint32_t>& order,
+                             size_t begin, size_t end, uint32_t trianglesPerBlock,
+                             std::vector<std::pair<size_t, size_t>>& outRanges) {
+            if (end - begin <= trianglesPerBlock) {
+                outRanges.emplace_back(begin, end);
+                return;
+            }
+
+            YAM::AABB centroidBounds;
+            for (size_t i = begin; i < end; ++i) {
+                ExpandBounds(centroidBounds, Centroid(triangles[order[i]]));
+            }
+
+            const YAM::Vector3 extent = centroidBounds.max - centroidBounds.min;
+            uint8_t axis = 0;
+            if (extent.y > extent[axis]) {
+                axis = 1;
+            }
+            if (extent.z > extent[axis]) {
+                axis = 2;
+            }
+
+            const size_t middle = begin + (end - begin) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                             [&triangles, axis](uint32_t a, uint32_t b) {
+                                 return Centroid(triangles[a])[axis] < Centroid(triangles[b])[axis];
+                             });
+
+            SplitIntoBlocks(triangles, order, begin, middle, trianglesPerBlock, outRanges);
+            SplitIntoBlocks(triangles, order, middle, end, trianglesPerBlock, outRanges);
+        }
+    }
+
+    PagedGeometryStore::PagedGeometryStore(const std::string& cachePath, uint64_t residentBudget)
+        : cachePath(cachePath)
+          , residentBudget(residentBudget)
+          , clockHand(0)
+          , fileSize(0)
+          , mappedFile(nullptr)
+          , mappedSize(0)
+          , residentBytes(0)
+          , peakResidentBytes(0)
+          , misses(0)
+          , pageIns(0)
+          , evictions(0) {
+        // Truncate leftovers of previous runs
+        std::ofstream cacheFile(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!cacheFile) {
+            spdlog::error("Cannot create geometry cache file {}", cachePath);
+        }
+    }
+
+    PagedGeometryStore::~PagedGeometryStore() {
+        UnmapFile();
+        std::remove(cachePath.c_str());
+    }
+
+    bool PagedGeometryStore::AddTriangles(std::span<const YAM::Triangle> triangles, uint32_t trianglesPerBlock,
+                                          std::vector<uint32_t>& outBlockIds) {
+        if (triangles.empty()) {
+            return true;
+        }
+
+        std::vector<uint32_t> order(triangles.size());
+        std::iota(order.begin(), order.end(), 0u);
+
+        std::vector<std::pair<size_t, size_t>> ranges;
+        SplitIntoBlocks(triangles, order, 0, order.size(), std::max(trianglesPerBlock, 1u), ranges);
+
+        std::scoped_lock lock{mutex};
+        for (const auto& [begin, end] : ranges) {
+            const uint32_t blockId = static_cast<uint32_t>(blocks.size());
+            if (!WriteBlock(triangles, order.data() + begin, static_cast<uint32_t>(end - begin))) {
+                return false;
+            }
+
+            outBlockIds.push_back(blockId);
+        }
+
+        return true;
+    }
+
+    bool PagedGeometryStore::WriteBlock(std::span<const YAM::Triangle> triangles, const uint32_t* order, uint32_t count) {
+        GeometryBlock block{};
+        block.offset = fileSize;
+        block.triangleCount = count;
+
+        // Positions of the whole block first, then normals
+        std::vector<float> data;
+        data.reserve(count * FloatsPerTriangle);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const YAM::Triangle& triangle = triangles[order[i]];
+            for (const YAM::Vector3* vector : {&triangle.posA, &triangle.posB, &triangle.posC}) {
+                data.push_back(vector->x);
+                data.push_back(vector->y);
+                data.push_back(vector->z);
+            }
+
+            ExpandBounds(block.bounds, triangle.posA);
+            ExpandBounds(block.bounds, triangle.posB);
+            ExpandBounds(block.bounds, triangle.posC);
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const YAM::Triangle& triangle = triangles[order[i]];
+            for (const YAM::Vector3* vector : {&triangle.norA, &triangle.norB, &triangle.norC}) {
+                data.push_back(vector->x);
+                data.push_back(vector->y);
+                data.push_back(vector->z);
+            }
+        }
+
+        std::ofstream cacheFile(cachePath, std::ios::out | std::ios::binary | std::ios::app);
+        cacheFile.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+        cacheFile.flush();
+
+        // A short write would leave fileSize past the end of the file and mapping it faults on access
+        if (!cacheFile) {
+            spdlog::error("Cannot write {} triangles to geometry cache file {}", count, cachePath);
+            return false;
+        }
+
+        fileSize += data.size() * sizeof(float);
+        blocks.push_back(block);
+        residentBlocks.emplace_back();
+
+        return true;
+    }
+
+    void PagedGeometryStore::MapFile() {
+        UnmapFile();
+
+#ifndef _WIN32
+        const int fileDescriptor = open(cachePath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) {
+            spdlog::error("Cannot open geometry cache file {}", cachePath);
+            return;
+        }
+
+        void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        close(fileDescriptor);
+
+        if (mapping == MAP_FAILED) {
+            spdlog::error("Cannot map geometry cache file {}", cachePath);
+            return;
+        }
+
+        mappedFile = static_cast<const char*>(mapping);
+        mappedSize = fileSize;
+#endif
+    }
+
+    void PagedGeometryStore::UnmapFile() {
+#ifndef _WIN32
+        if (mappedFile != nullptr) {
+            munmap(const_cast<char*>(mappedFile), mappedSize);
+        }
+#endif
+        mappedFile = nullptr;
+        mappedSize = 0;
+    }
+
+    std::shared_ptr<const TriangleBlock> PagedGeometryStore::Acquire(uint32_t blockId) {
+        ResidentEntry& entry = residentBlocks[blockId];
+
+        const auto hit = [&entry](std::shared_ptr<const TriangleBlock> triangles) {
+            // Checked first, so hot blocks do not keep writing the same cache line
+            if (!entry.referenced.load(std::memory_order_relaxed)) {
+                entry.referenced.store(true, std::memory_order_relaxed);
+            }
+            entry.hits.fetch_add(1, std::memory_order_relaxed);
+            return triangles;
+        };
+
+        if (std::shared_ptr<const TriangleBlock> triangles = entry.triangles.load(std::memory_order_acquire)) {
+            return hit(std::move(triangles));
+        }
+
+        std::scoped_lock lock{mutex};
+
+        // Another thread may have paged the block in while this one waited
+        if (std::shared_ptr<const TriangleBlock> triangles = entry.triangles.load(std::memory_order_acquire)) {
+            return hit(std::move(triangles));
+        }
+
+        ++misses;
+        return PageIn(blockId);
+    }
+
+    std::shared_ptr<const TriangleBlock> PagedGeometryStore::PageIn(uint32_t blockId) {
+        const GeometryBlock& block = blocks[blockId];
+        const uint64_t blockBytes = block.triangleCount * BytesPerResidentTriangle;
+
+        EvictUntilFits(blockBytes);
+
+        if (mappedSize != fileSize) {
+            MapFile();
+        }
+
+        std::vector<float> fallbackData;
+        const float* data = nullptr;
+        if (mappedFile != nullptr) {
+            data = reinterpret_cast<const float*>(mappedFile + block.offset);
+        }
+        else {
+            fallbackData.resize(block.triangleCount * FloatsPerTriangle);
+
+            std::ifstream cacheFile(cachePath, std::ios::in | std::ios::binary);
+            cacheFile.seekg(static_cast<std::streamoff>(block.offset));
+            cacheFile.read(reinterpret_cast<char*>(fallbackData.data()), block.triangleCount * BytesPerTriangle);
+            data = fallbackData.data();
+        }
+
+        std::shared_ptr<TriangleBlock> triangles = std::make_shared<TriangleBlock>();
+        triangles->positions.reserve(block.triangleCount);
+        triangles->normals.reserve(block.triangleCount);
+
+        const float* normalData = data + block.triangleCount * FloatsPerAttribute;
+        for (uint32_t i = 0; i < block.triangleCount; ++i) {
+            const float* p = data + i * FloatsPerAttribute;
+            triangles->positions.push_back({
+                YAM::Vector3{p[0], p[1], p[2]}, YAM::Vector3{p[3], p[4], p[5]}, YAM::Vector3{p[6], p[7], p[8]}
+            });
+
+            const float* n = normalData + i * FloatsPerAttribute;
+            triangles->normals.push_back({
+                YAM::Vector3{n[0], n[1], n[2]}, YAM::Vector3{n[3], n[4], n[5]}, YAM::Vector3{n[6], n[7], n[8]}
+            });
+        }
+
+        ResidentEntry& entry = residentBlocks[blockId];
+        entry.referenced.store(true, std::memory_order_relaxed);
+        entry.triangles.store(triangles, std::memory_order_release);
+        clock.push_back(blockId);
+
+        residentBytes += blockBytes;
+        peakResidentBytes = std::max(peakResidentBytes, residentBytes);
+        ++pageIns;
+
+        return triangles;
+    }
+
+    void PagedGeometryStore::EvictUntilFits(uint64_t incomingBytes) {
+        // Hits can set referenced again behind the hand, so second chances are limited to one sweep
+        size_t secondChances = 0;
+
+        while (!clock.empty() && residentBytes + incomingBytes > residentBudget) {
+            if (clockHand >= clock.size()) {
+                clockHand = 0;
+            }
+
+            const uint32_t candidateId = clock[clockHand];
+            ResidentEntry& candidate = residentBlocks[candidateId];
+            if (candidate.referenced.exchange(false, std::memory_order_relaxed) && secondChances < clock.size()) {
+                ++secondChances;
+                ++clockHand;
+                continue;
+            }
+
+            // The last resident block takes the place of the victim, the hand stays to visit it
+            candidate.triangles.store(nullptr, std::memory_order_release);
+            clock[clockHand] = clock.back();
+            clock.pop_back();
+
+            residentBytes -= blocks[candidateId].triangleCount * BytesPerResidentTriangle;
+            ++evictions;
+        }
+    }
+
+    PagingStats PagedGeometryStore::GetStats() const {
+        std::scoped_lock lock{mutex};
+
+        PagingStats stats{};
+        stats.hits = 0;
+        for (const ResidentEntry& entry : residentBlocks) {
+            stats.hits += entry.hits.load(std::memory_order_relaxed);
+        }
+        stats.misses = misses;
+        stats.pageIns = pageIns;
+        stats.evictions = evictions;
+        stats.residentBytes = residentBytes;
+        stats.peakResidentBytes = peakResidentBytes;
+
+        return stats;
+    }
+
+    void PagedGeometryStore::LogStats() const {
+        const PagingStats stats = GetStats();
+
+        spdlog::info("Geometry paging: {} blocks, {} page-ins, {} evictions, hit rate {:.2f}%",
+                     blocks.size(), stats.pageIns, stats.evictions, 100.f * stats.HitRate());
+        spdlog::info("Geometry paging: resident {} KiB, peak {} KiB, budget {} KiB",
+                     stats.residentBytes / 1024, stats.peakResidentBytes / 1024, residentBudget / 1024);
+    }
+} // YAR
@@ -2,20 +2,41 @@
 
 #include "Buffer.h"
 #include "Camera.h"
+#include "Kernels.h"
 #include "Renderable.h"
+#include "Sampler.h"
 
 namespace YAR{
-    RenderWorker::RenderWorker(Renderer& owner, const std::shared_ptr<Camera>& camera, const RenderBounds& renderBounds)
-    : owner(owner), camera(camera), renderBounds(renderBounds) {
-        random.SetRandomSeed(renderBounds.minX + renderBounds.minY * owner.colorBuffer->GetSizeX() + 195487);
+    namespace {
+        // Shadow rays stop this fraction short of the light, so they cannot hit the light itself
+        constexpr float ShadowRayMargin = 1e-3f;
+
+        // Veach's power heuristic, weight of a sample drawn with pdf when otherPdf could have drawn it too
+        YAM::flt PowerHeuristic(YAM::flt pdf, YAM::flt otherPdf) {
+            const YAM::flt squared = pdf * pdf;
+            const YAM::flt sum = squared + otherPdf * otherPdf;
+            return sum > 0.f ? squared / sum : 0.f;
+        }
     }
 
+    RenderWorker::RenderWorker(Renderer& owner, const std::shared_ptr<Camera>& camera, const RenderBounds& renderBounds)
+    : owner(owner), camera(camera), renderBounds(renderBounds), sampler(owner.GetSampler().Clone()) {}
+
+    RenderWorker::~RenderWorker() = default;
+
     void RenderWorker::StartRender() const {
         uint32_t samplesPerPixel = owner.GetSamplesPerPixel();
         
         std::vector<YAM::Vector3> samples;
         samples.resize(samplesPerPixel);
 
+        // Rows are tonemapped in one batch and written under a single lock
+        const uint32_t rowSize = renderBounds.maxX - renderBounds.minX;
+        std::vector<YAM::Vector3> rowColors(rowSize);
+        std::vector<uint32_t> rowPixels(rowSize);
+
+        const YAM::KernelTable& kernels = YAM::Kernels::Get();
+
         for (uint32_t i = renderBounds.minY; i < renderBounds.maxY; ++i) {
             for (uint32_t j = renderBounds.minX; j < renderBounds.maxX; ++j) {
                 for (YAM::Vector3& sample : samples) {
@@ -23,86 +44,101 @@ namespace YAR{
                 }
 
                 for (uint32_t sampleID = 0; sampleID < samplesPerPixel; ++sampleID) {
-                    samples[sampleID] = SamplePixel(camera.get(), i, j);
+                    samples[sampleID] = SamplePixel(camera.get(), i, j, sampleID);
                 }
 
                 YAM::Vector3 finalColor = YAM::Vector3{0};
                 for (uint32_t sampleID = 0; sampleID < samplesPerPixel; ++sampleID) {
                     finalColor += samples[sampleID];
                 }
-                
-                {
-                    std::scoped_lock lock{owner.colorBufferMutex};
-                    owner.colorBuffer->SetPix(j, i, YAM::Color::FromVector(finalColor / static_cast<YAM::flt>(samplesPerPixel)).hex);
+
+                rowColors[j - renderBounds.minX] = finalColor;
+            }
+
+            kernels.tonemap(rowColors.data(), rowSize, static_cast<YAM::flt>(samplesPerPixel), rowPixels.data());
+
+            {
+                std::scoped_lock lock{owner.colorBufferMutex};
+                for (uint32_t j = renderBounds.minX; j < renderBounds.maxX; ++j) {
+                    owner.colorBuffer->SetPix(j, i, rowPixels[j - renderBounds.minX]);
                 }
             }
         }
     }
 
-    YAM::Vector3 RenderWorker::SamplePixel(const Camera* camera, uint32_t y, uint32_t x) const {
-        YAM::Ray ray = camera->GetRay(x, y, random);
+    YAM::Vector3 RenderWorker::SamplePixel(const Camera* camera, uint32_t y, uint32_t x, uint32_t sampleID) const {
+        // Sample values only depend on the pixel and sample, not on which worker renders it
+        sampler->StartPixelSample(x, y, sampleID);
+        YAM::Ray ray = camera->GetRay(x, y, *sampler);
 
         YAM::Vector3 finalColor {0.f};
         YAM::Vector3 rayColor {1.f};
 
+        // How the current ray was scattered. Light sampling cannot find what camera rays and delta
+        // lobes hit, so emission they reach counts fully.
+        bool deltaBounce = true;
+        YAM::flt bouncePdf = 0.f;
+
         uint32_t maxBounces = owner.GetMaxBounces();
         
         for (uint32_t bounceId = 0; bounceId <= maxBounces; ++bounceId) {
             RenderHitInfo hitInfo;
 
-            if (CalculateRayCollision(ray, hitInfo)) {
-                const Material* material = hitInfo.material;
-                
-                // cosine weighted ray districution
-                const YAM::Vector3 diffuse = (hitInfo.normal + random.RandomDirection()).Normal();
-                const YAM::Vector3 specular = Reflect(ray.direction, hitInfo.normal);
-
-                const float dirDotNormal = YAM::Vector3::Dot(ray.direction, hitInfo.normal);
-                const float refractiveRatio = dirDotNormal < std::numeric_limits<float>::min()
-                    ? 1.f / material->refractiveIndex
-                    : material->refractiveIndex / 1.f;
-
-                const YAM::Vector3 refraction = Refract(ray.direction, hitInfo.normal, refractiveRatio);
-                
-                ray.direction = YAM::Vector3::Lerp(diffuse, specular, hitInfo.material->specular);
-
-                float fresnell = 1.f - YAM::Fresnell(ray.direction, hitInfo.normal);
-                fresnell = std::pow(fresnell, 0.6f);
-                
-                ray.direction = YAM::Vector3::Lerp(ray.direction, refraction, material->transparency * fresnell);
-                    
-                const YAM::Vector3 materialColor = material->color.ToVector();
-                const YAM::Vector3 emissionColor = material->emisiveColor.ToVector();
-                const YAM::Vector3 emitedLight = emissionColor * material->emmision;
-                float lightStrenght = YAM::Vector3::Dot(hitInfo.normal, ray.direction);
-                lightStrenght = YAM::Lerp(lightStrenght, 1.f, material->transparency * fresnell);
-                
-                finalColor += emitedLight.Mul(rayColor);
-                rayColor = rayColor.Mul(materialColor) * lightStrenght;
-                
-                ray.point = hitInfo.hitPoint;
+            if (!CalculateRayCollision(ray, hitInfo)) {
+                break;
+            }
+
+            const Material& material = owner.scene.GetMaterial(hitInfo.materialID);
+
+            if (deltaBounce || hitInfo.lightID == RenderHitInfo::NoLight) {
+                finalColor += material.GetEmittedLight().Mul(rayColor);
             }
             else {
+                // The light sample of the previous hit could have picked this point too
+                const YAM::flt lightPdf = owner.scene.GetLightPdf(hitInfo.lightID, ray.point, hitInfo.hitPoint);
+                finalColor += material.GetEmittedLight().Mul(rayColor) * PowerHeuristic(bouncePdf, lightPdf);
+            }
+
+            // Every bounce takes the same dimensions, whichever lobe it ends up using
+            YAM::flt lobeU, lightU, lightX, lightY, scatterX, scatterY;
+            sampler->Get2D(lobeU, lightU);
+            sampler->Get2D(lightX, lightY);
+            sampler->Get2D(scatterX, scatterY);
+
+            // Paths end at the last hit, light sampling is the only strategy left for it
+            const bool lastBounce = bounceId == maxBounces;
+
+            LightSample lightSample;
+            if (owner.scene.SampleLight(hitInfo.hitPoint, lightU, lightX, lightY, lightSample)) {
+                YAM::flt materialPdf;
+                const YAM::Vector3 reflected = material.Evaluate(ray.direction, hitInfo.normal,
+                                                                 lightSample.direction, materialPdf);
+                const YAM::Ray shadowRay{lightSample.direction, hitInfo.hitPoint};
+
+                if (materialPdf > 0.f
+                    && !owner.scene.IsOccluded(shadowRay, lightSample.distance * (1.f - ShadowRayMargin))) {
+                    const YAM::flt weight = lastBounce ? 1.f : PowerHeuristic(lightSample.pdf, materialPdf);
+                    finalColor += lightSample.radiance.Mul(rayColor).Mul(reflected) * (weight / lightSample.pdf);
+                }
+            }
+
+            if (lastBounce) {
                 break;
             }
+
+            const MaterialSample scatter = material.Sample(ray.direction, hitInfo.normal, lobeU, scatterX, scatterY);
+            rayColor = rayColor.Mul(scatter.weight);
+            deltaBounce = scatter.isDelta;
+            bouncePdf = scatter.pdf;
+
+            ray.direction = scatter.direction;
+            ray.point = hitInfo.hitPoint;
         }
 
         return finalColor;
     }
 
     bool RenderWorker::CalculateRayCollision(const YAM::Ray& ray, RenderHitInfo& outHit) const {
-        outHit.distance = std::numeric_limits<YAM::flt>::max();
-
-        bool wasIntersection = false;
-        for (const std::shared_ptr<Renderable>& renderable : owner.renderables) {
-            RenderHitInfo hit;
-            
-            if (renderable->Trace(ray, hit) && hit.distance < outHit.distance) {
-                outHit = hit;
-                wasIntersection = true;
-            }
-        }
-
-        return wasIntersection;
+        return owner.scene.Trace(ray, outHit);
     }
 } // YAR
@@ -1,5 +1,10 @@
 #include "Renderable.h"
 
+#include <algorithm>
+#include <array>
+
+#include "Algorithms.h"
+#include "Kernels.h"
 #include "spdlog/spdlog.h"
 
 using namespace YAR;
@@ -12,8 +17,67 @@ Material::Material()
       , transparency(0)
       , refractiveIndex(1) {}
 
+YAM::Vector3 Material::Evaluate(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                                const YAM::Vector3& direction, YAM::flt& outPdf) const {
+    float diffuseChance, specularChance;
+    GetLobeChances(incoming, normal, diffuseChance, specularChance);
+
+    // color / pi * cos of the Lambertian lobe equals color times its cosine weighted pdf
+    outPdf = diffuseChance * YAM::SampleWarp::CosineHemispherePdf(YAM::Vector3::Dot(normal, direction));
+    return color.ToVector() * outPdf;
+}
+
+MaterialSample Material::Sample(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                                YAM::flt lobeU, YAM::flt u, YAM::flt v) const {
+    float diffuseChance, specularChance;
+    GetLobeChances(incoming, normal, diffuseChance, specularChance);
+
+    // Picking each lobe as often as it weighs cancels the weight, only the color is left
+    MaterialSample sample{};
+    sample.weight = color.ToVector();
+
+    if (lobeU < diffuseChance) {
+        sample.direction = YAM::SampleWarp::SquareToCosineHemisphere(u, v, normal);
+        sample.pdf = diffuseChance
+            * YAM::SampleWarp::CosineHemispherePdf(YAM::Vector3::Dot(normal, sample.direction));
+        sample.isDelta = false;
+        return sample;
+    }
+
+    sample.pdf = 0.f;
+    sample.isDelta = true;
+
+    if (lobeU < diffuseChance + specularChance) {
+        sample.direction = YAM::Reflect(incoming, normal);
+        return sample;
+    }
+
+    const float dirDotNormal = YAM::Vector3::Dot(incoming, normal);
+    const float refractiveRatio = dirDotNormal < std::numeric_limits<float>::min()
+        ? 1.f / refractiveIndex
+        : refractiveIndex / 1.f;
+
+    // Total internal reflection mirrors instead
+    sample.direction = YAM::Refract(incoming, normal, refractiveRatio);
+    if (sample.direction == YAM::Vector3{0.f}) {
+        sample.direction = YAM::Reflect(incoming, normal);
+    }
+
+    return sample;
+}
+
+void Material::GetLobeChances(const YAM::Vector3& incoming, const YAM::Vector3& normal,
+                              float& outDiffuse, float& outSpecular) const {
+    const float cosIncoming = std::abs(YAM::Vector3::Dot(incoming, normal));
+    const float refractChance = transparency * YAM::Transcendentals::Pow(cosIncoming, 0.6f);
+
+    outSpecular = (1.f - refractChance) * specular;
+    outDiffuse = 1.f - refractChance - outSpecular;
+}
+
 RenderHitInfo::RenderHitInfo()
-    : material() {}
+    : materialID(0)
+      , lightID(NoLight) {}
 
 Renderable::Renderable(const Material& material)
     : material(material) {}
@@ -27,45 +91,249 @@ SphereRenderable::SphereRenderable(const Material& material, const YAM::Sphere&
 SphereRenderable::~SphereRenderable() = default;
 
 bool SphereRenderable::Trace(const YAM::Ray& ray, RenderHitInfo& hitInfo) {
-    bool intersects = YAM::LinearMath::FindIntersection(ray, sphere, hitInfo);
-
-    if (intersects) {
-        hitInfo.material = &GetMaterial();
-    }
-
-    return intersects;
+    return YAM::LinearMath::FindIntersection(ray, sphere, hitInfo);
 }
 
 MeshRenderable::MeshRenderable(const Material& material, const std::string& objPath)
     : Renderable(material)
-      , mesh(objPath) {}
+      , mesh(std::make_unique<Mesh>(objPath))
+      , pendingTransform(1.f)
+      , pendingStorage(MeshStorage::Full)
+      , loaded(true) {}
+
+MeshRenderable::MeshRenderable(const Material& material, const std::string& objPath, const YAM::AABB& proxyBounds)
+    : Renderable(material)
+      , objPath(objPath)
+      , proxyBounds(proxyBounds)
+      , pendingTransform(1.f)
+      , pendingStorage(MeshStorage::Full)
+      , loaded(false) {}
 
 MeshRenderable::~MeshRenderable() = default;
 
 bool MeshRenderable::Trace(const YAM::Ray& ray, RenderHitInfo& outHit) {
-    if (!YAM::LinearMath::FindIntersection(ray, mesh.GetBoudingBox())) {
+    const YAM::TraversalRay traversalRay(ray);
+    if (!IsLoaded()) {
+        if (!YAM::LinearMath::FindIntersection(traversalRay, proxyBounds)) {
+            return false;
+        }
+
+        std::call_once(loadFlag, &MeshRenderable::Load, this);
+    }
+
+    const Mesh& mesh = *this->mesh;
+    if (!YAM::LinearMath::FindIntersection(traversalRay, mesh.GetBoudingBox())) {
         return false;
     }
 
-    outHit.distance = std::numeric_limits<float>::max();
+    YAM::TriangleHit closestHit{std::numeric_limits<float>::max(), 0.f, 0.f};
+    uint32_t closestTriangleID = std::numeric_limits<uint32_t>::max();
 
-    RenderHitInfo currentHit;
-    bool wasHit = false;
+    const std::vector<TriangleIndices>& indices = mesh.GetIndices();
 
-    for (YAM::Triangle tri : mesh.GetTriangles()) {
-        if (YAM::LinearMath::FindIntersection(ray, tri, currentHit)) {
-            if (currentHit.distance < outHit.distance) {
-                outHit = currentHit;
-                outHit.material = &GetMaterial();
+    // Traversal streams positions only, normals are fetched once for the closest hit
+    if (mesh.GetStorage() == MeshStorage::Full) {
+        closestTriangleID = YAM::Kernels::Get().intersectTriangles(
+            ray, mesh.GetPositions().data(), indices.data(), mesh.GetTriangleCount(), closestHit);
+    }
+    else {
+        for (uint32_t triangleID = 0; triangleID < indices.size(); ++triangleID) {
+            const TriangleIndices& tri = indices[triangleID];
 
-                wasHit = true;
+            YAM::TriangleHit currentHit;
+            if (YAM::LinearMath::FindIntersection(ray,
+                                                  mesh.DecodePosition(tri.a), mesh.DecodePosition(tri.b),
+                                                  mesh.DecodePosition(tri.c), currentHit)
+                && currentHit.distance < closestHit.distance) {
+                closestHit = currentHit;
+                closestTriangleID = triangleID;
             }
         }
     }
 
-    return wasHit;
+    if (closestTriangleID == std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    const TriangleIndices& tri = indices[closestTriangleID];
+    if (mesh.GetStorage() == MeshStorage::Full) {
+        const std::vector<YAM::Vector3>& normals = mesh.GetNormals();
+        outHit.normal = YAM::LinearMath::InterpolateNormal(normals[tri.a], normals[tri.b], normals[tri.c], closestHit);
+    }
+    else {
+        outHit.normal = YAM::LinearMath::InterpolateNormal(
+            mesh.DecodeNormal(tri.a), mesh.DecodeNormal(tri.b), mesh.DecodeNormal(tri.c), closestHit);
+    }
+
+    outHit.hitPoint = ray.point + ray.direction * closestHit.distance;
+    outHit.distance = closestHit.distance;
+
+    return true;
 }
 
 void MeshRenderable::Transform(const YAM::Mat4& mat4) {
-    mesh.Transform(mat4);
+    if (IsLoaded()) {
+        mesh->Transform(mat4);
+        return;
+    }
+
+    const YAM::Mat3x4 affine(mat4);
+    pendingTransform = affine * pendingTransform;
+
+    // Transform all eight corners, so declared bounds stay conservative under rotation
+    std::array<YAM::Vector3, 8> corners;
+    for (uint32_t corner = 0; corner < corners.size(); ++corner) {
+        corners[corner] = YAM::Vector3{
+            corner & 1 ? proxyBounds.max.x : proxyBounds.min.x,
+            corner & 2 ? proxyBounds.max.y : proxyBounds.min.y,
+            corner & 4 ? proxyBounds.max.z : proxyBounds.min.z
+        };
+    }
+    YAM::Mat3x4::TransformPoints(affine, corners.data(), corners.data(), corners.size());
+
+    YAM::AABB transformedBounds;
+    for (const YAM::Vector3& transformed : corners) {
+        transformedBounds.min.x = std::min(transformedBounds.min.x, transformed.x);
+        transformedBounds.min.y = std::min(transformedBounds.min.y, transformed.y);
+        transformedBounds.min.z = std::min(transformedBounds.min.z, transformed.z);
+
+        transformedBounds.max.x = std::max(transformedBounds.max.x, transformed.x);
+        transformedBounds.max.y = std::max(transformedBounds.max.y, transformed.y);
+        transformedBounds.max.z = std::max(transformedBounds.max.z, transformed.z);
+    }
+
+    proxyBounds = transformedBounds;
+}
+
+void MeshRenderable::SetStorage(MeshStorage storage) {
+    if (IsLoaded()) {
+        mesh->SetStorage(storage);
+        return;
+    }
+
+    pendingStorage = storage;
+}
+
+void MeshRenderable::Load() {
+    std::unique_ptr<Mesh> loadedMesh = std::make_unique<Mesh>(objPath);
+    loadedMesh->Transform(pendingTransform);
+    loadedMesh->SetStorage(pendingStorage);
+
+    spdlog::info("Loaded proxy mesh {}", objPath);
+    mesh = std::move(loadedMesh);
+    loaded.store(true, std::memory_order_release);
+}
+
+PagedMeshRenderable::PagedMeshRenderable(const Material& material, const std::string& objPath,
+                                         const YAM::Mat4& transform,
+                                         const std::shared_ptr<PagedGeometryStore>& store,
+                                         uint32_t trianglesPerBlock)
+    : Renderable(material)
+      , store(store) {
+    Mesh::StreamTriangles(objPath, transform, StreamChunkSize, [&](std::span<const YAM::Triangle> triangles) {
+        AddChunk(triangles, trianglesPerBlock);
+    });
+}
+
+PagedMeshRenderable::PagedMeshRenderable(const Material& material, const Mesh& mesh,
+                                         const std::shared_ptr<PagedGeometryStore>& store,
+                                         uint32_t trianglesPerBlock)
+    : Renderable(material)
+      , store(store) {
+    std::vector<YAM::Triangle> chunk;
+    chunk.reserve(std::min(StreamChunkSize, mesh.GetTriangleCount()));
+
+    for (uint32_t triangleID = 0; triangleID < mesh.GetTriangleCount(); ++triangleID) {
+        chunk.push_back(mesh.GetTriangle(triangleID));
+
+        if (chunk.size() == StreamChunkSize) {
+            AddChunk(chunk, trianglesPerBlock);
+            chunk.clear();
+        }
+    }
+
+    AddChunk(chunk, trianglesPerBlock);
+}
+
+void PagedMeshRenderable::AddChunk(std::span<const YAM::Triangle> triangles, uint32_t trianglesPerBlock) {
+    const size_t firstNewBlock = blockIds.size();
+    store->AddTriangles(triangles, trianglesPerBlock, blockIds);
+
+    for (size_t i = firstNewBlock; i < blockIds.size(); ++i) {
+        const YAM::AABB& bounds = store->GetBlock(blockIds[i]).bounds;
+        blockBounds.push_back(bounds);
+
+        boundingBox.min.x = std::min(boundingBox.min.x, bounds.min.x);
+        boundingBox.min.y = std::min(boundingBox.min.y, bounds.min.y);
+        boundingBox.min.z = std::min(boundingBox.min.z, bounds.min.z);
+
+        boundingBox.max.x = std::max(boundingBox.max.x, bounds.max.x);
+        boundingBox.max.y = std::max(boundingBox.max.y, bounds.max.y);
+        boundingBox.max.z = std::max(boundingBox.max.z, bounds.max.z);
+    }
+}
+
+PagedMeshRenderable::~PagedMeshRenderable() = default;
+
+bool PagedMeshRenderable::Trace(const YAM::Ray& ray, RenderHitInfo& outHit) {
+    const YAM::TraversalRay traversalRay(ray);
+    if (!YAM::LinearMath::FindIntersection(traversalRay, boundingBox)) {
+        return false;
+    }
+
+    YAM::TriangleHit closestHit{std::numeric_limits<float>::max(), 0.f, 0.f};
+    std::shared_ptr<const TriangleBlock> closestBlock;
+    uint32_t closestTriangleID = 0;
+
+    const YAM::KernelTable& kernels = YAM::Kernels::Get();
+
+    // Entry distance and index of every block the ray crosses, reused between rays of a thread
+    thread_local std::vector<std::pair<YAM::flt, uint32_t>> crossedBlocks;
+    crossedBlocks.clear();
+
+    // Block bounds are kept in memory, so missed blocks never get paged in
+    for (uint32_t first = 0; first < blockIds.size(); first += BoundsBatchSize) {
+        const uint32_t count = std::min(BoundsBatchSize, static_cast<uint32_t>(blockIds.size()) - first);
+
+        uint8_t blockHits[BoundsBatchSize];
+        if (kernels.intersectBoxes(traversalRay, blockBounds.data() + first, count, blockHits) == 0) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            YAM::flt entry;
+            if (blockHits[i] && YAM::LinearMath::FindIntersection(traversalRay, blockBounds[first + i], entry)) {
+                crossedBlocks.emplace_back(entry, first + i);
+            }
+        }
+    }
+
+    // Nearest first, so blocks behind the closest hit are neither paged in nor evict anything
+    std::sort(crossedBlocks.begin(), crossedBlocks.end());
+
+    for (const auto& [entry, index] : crossedBlocks) {
+        if (entry >= closestHit.distance) {
+            break;
+        }
+
+        std::shared_ptr<const TriangleBlock> block = store->Acquire(blockIds[index]);
+        const uint32_t triangleID = kernels.intersectTrianglePositions(
+            ray, block->positions.data(), static_cast<uint32_t>(block->positions.size()), closestHit);
+
+        if (triangleID != std::numeric_limits<uint32_t>::max()) {
+            closestBlock = block;
+            closestTriangleID = triangleID;
+        }
+    }
+
+    if (!closestBlock) {
+        return false;
+    }
+
+    const YAM::TriangleNormals& normals = closestBlock->normals[closestTriangleID];
+    outHit.normal = YAM::LinearMath::InterpolateNormal(normals.norA, normals.norB, normals.norC, closestHit);
+    outHit.hitPoint = ray.point + ray.direction * closestHit.distance;
+    outHit.distance = closestHit.distance;
+
+    return true;
 }
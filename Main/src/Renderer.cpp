@@ -3,9 +3,11 @@
 #include "Algorithms.h"
 #include "Buffer.h"
 #include "Camera.h"
+#include "CpuFeatures.h"
 #include "LinearMath.h"
 #include "Renderable.h"
 #include "RenderWorker.h"
+#include "Sampler.h"
 #include "TGAWriter.h"
 #include "spdlog/spdlog.h"
 
@@ -17,17 +19,26 @@ namespace YAR{
         : colorBufferMutex()
           , samplesPerPixel(samplesPerPixel)
           , maxBounces(maxBounces)
-          , tilesPerRow(tilesPerRow) {
+          , tilesPerRow(tilesPerRow)
+          , sampler(std::make_shared<SobolSampler>(RenderSeed)) {
         colorBuffer = std::make_unique<YAR::Buffer>(sizeX, sizeY);
     }
 
     Renderer::~Renderer() = default;
 
     void Renderer::AddRenderable(const std::shared_ptr<Renderable>& renderable) {
-        renderables.push_back(renderable);
+        scene.AddRenderable(renderable);
     }
 
     void Renderer::Render(const std::shared_ptr<YAR::Camera> camera) {
+        if (!scene.IsCommitted()) {
+            spdlog::warn("Scene was not committed before rendering, committing now");
+            scene.Commit();
+        }
+
+        spdlog::info("Rendering with {} kernels, CPU supports {}",
+                     CpuFeatures::ToString(CpuFeatures::GetLevel()), CpuFeatures::ToString(CpuFeatures::Detect()));
+
         colorBuffer->FillColor(0xff000000);
 
         const uint32_t tilesNum = tilesPerRow * tilesPerRow;
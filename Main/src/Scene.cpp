@@ -0,0 +1,353 @@
+#include "Scene.h"
+
+#include <algorithm>
+
+#include "Algorithms.h"
+#include "Kernels.h"
+#include "spdlog/spdlog.h"
+
+namespace YAR{
+    namespace {
+        // Mesh bounds culled per kernel call
+        constexpr uint32_t BoundsBatchSize = 64;
+
+        // Rec. 709 weights, how bright an emitter looks rather than its raw channel sum
+        YAM::flt Luminance(const YAM::Vector3& color) {
+            return 0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z;
+        }
+
+        // 1 - cos of the half angle of the cone in which sphere is seen from point,
+        // false when point is inside and every direction sees the sphere
+        bool VisibleCone(const YAM::Sphere& sphere, const YAM::Vector3& point, YAM::flt& outOneMinusCosThetaMax) {
+            const YAM::Vector3 toCenter = sphere.center - point;
+            const YAM::flt sinSquared = sphere.radius * sphere.radius / YAM::Vector3::Dot(toCenter, toCenter);
+            if (!(sinSquared < 1.f)) {
+                return false;
+            }
+
+            // Below about 1.5 degrees 1 - sqrt(1 - x) cancels, its series x / 2 does not
+            outOneMinusCosThetaMax = sinSquared < 0.00068523f
+                ? 0.5f * sinSquared
+                : 1.f - std::sqrt(1.f - sinSquared);
+            return true;
+        }
+    }
+
+    Scene::Scene()
+        : committed(false) {}
+
+    Scene::~Scene() = default;
+
+    void Scene::AddRenderable(const std::shared_ptr<Renderable>& renderable) {
+        renderables.push_back(renderable);
+        committed = false;
+    }
+
+    void Scene::Clear() {
+        materials.clear();
+
+        spheres.clear();
+        meshes.clear();
+        meshBounds.clear();
+        customRenderables.clear();
+
+        positions.clear();
+        normals.clear();
+        triangles.clear();
+
+        lights.clear();
+        lightTable = YAM::AliasTable();
+    }
+
+    void Scene::Commit() {
+        Clear();
+
+        for (const std::shared_ptr<Renderable>& renderable : renderables) {
+            const uint32_t materialID = static_cast<uint32_t>(materials.size());
+            materials.push_back(renderable->GetMaterial());
+
+            if (const SphereRenderable* sphere = dynamic_cast<const SphereRenderable*>(renderable.get())) {
+                FlattenSphere(*sphere, materialID);
+                continue;
+            }
+
+            // Proxies have to stay lazy, compact meshes would lose their compression
+            const MeshRenderable* meshRenderable = dynamic_cast<const MeshRenderable*>(renderable.get());
+            if (meshRenderable != nullptr && meshRenderable->GetMesh() != nullptr
+                && meshRenderable->GetMesh()->GetStorage() == MeshStorage::Full) {
+                FlattenMesh(*meshRenderable->GetMesh(), materialID);
+                continue;
+            }
+
+            customRenderables.push_back({renderable.get(), materialID});
+        }
+
+        BuildLights();
+
+        committed = true;
+
+        spdlog::info("Scene committed: {} spheres, {} meshes ({} triangles), {} other renderables, {} lights",
+                     spheres.size(), meshes.size(), triangles.size(), customRenderables.size(), lights.size());
+    }
+
+    void Scene::FlattenSphere(const SphereRenderable& sphere, uint32_t materialID) {
+        uint32_t lightID = RenderHitInfo::NoLight;
+        if (materials[materialID].IsEmissive()) {
+            const YAM::flt radius = sphere.GetSphere().radius;
+            lightID = static_cast<uint32_t>(lights.size());
+            lights.push_back({LightShape::Sphere, static_cast<uint32_t>(spheres.size()), materialID,
+                              static_cast<YAM::flt>(4. * M_PI) * radius * radius});
+        }
+
+        spheres.push_back({sphere.GetSphere(), materialID, lightID});
+    }
+
+    void Scene::FlattenMesh(const Mesh& mesh, uint32_t materialID) {
+        const uint32_t firstVertex = static_cast<uint32_t>(positions.size());
+
+        SceneMesh sceneMesh{};
+        sceneMesh.firstTriangle = static_cast<uint32_t>(triangles.size());
+        sceneMesh.triangleCount = mesh.GetTriangleCount();
+        sceneMesh.materialID = materialID;
+        sceneMesh.firstLight = RenderHitInfo::NoLight;
+
+        positions.insert(positions.end(), mesh.GetPositions().begin(), mesh.GetPositions().end());
+        normals.insert(normals.end(), mesh.GetNormals().begin(), mesh.GetNormals().end());
+
+        for (const TriangleIndices& triangle : mesh.GetIndices()) {
+            triangles.push_back({triangle.a + firstVertex, triangle.b + firstVertex, triangle.c + firstVertex});
+        }
+
+        if (materials[materialID].IsEmissive()) {
+            sceneMesh.firstLight = static_cast<uint32_t>(lights.size());
+            for (uint32_t i = 0; i < sceneMesh.triangleCount; ++i) {
+                const TriangleIndices& triangle = triangles[sceneMesh.firstTriangle + i];
+                const YAM::Vector3 cross = YAM::Vector3::Cross(positions[triangle.b] - positions[triangle.a],
+                                                               positions[triangle.c] - positions[triangle.a]);
+                lights.push_back({LightShape::Triangle, sceneMesh.firstTriangle + i, materialID, 0.5f * cross.Length()});
+            }
+        }
+
+        meshes.push_back(sceneMesh);
+        meshBounds.push_back(mesh.GetBoudingBox());
+    }
+
+    void Scene::BuildLights() {
+        std::vector<YAM::flt> powers;
+        powers.reserve(lights.size());
+        for (const SceneLight& light : lights) {
+            powers.push_back(light.area * Luminance(materials[light.materialID].GetEmittedLight()));
+        }
+
+        lightTable = YAM::AliasTable(powers);
+    }
+
+    bool Scene::SampleLight(const YAM::Vector3& point, YAM::flt lightU, YAM::flt u, YAM::flt v,
+                            LightSample& outSample) const {
+        if (lightTable.IsEmpty()) {
+            return false;
+        }
+
+        YAM::flt pickPdf;
+        const SceneLight& light = lights[lightTable.Sample(lightU, pickPdf)];
+
+        YAM::Vector3 lightPoint;
+        if (light.shape == LightShape::Sphere) {
+            const YAM::Sphere& sphere = spheres[light.primitive].sphere;
+
+            // From outside only the cap facing point is visible, sampling its cone wastes nothing
+            YAM::flt oneMinusCosThetaMax;
+            if (VisibleCone(sphere, point, oneMinusCosThetaMax)) {
+                const YAM::Vector3 toCenter = sphere.center - point;
+                const YAM::flt centerDistanceSquared = YAM::Vector3::Dot(toCenter, toCenter);
+                const YAM::Vector3 axis = toCenter / std::sqrt(centerDistanceSquared);
+                const YAM::Vector3 direction = YAM::SampleWarp::SquareToCone(u, v, oneMinusCosThetaMax, axis);
+
+                // Nearer intersection, directions at the rim graze the sphere up to rounding
+                const YAM::flt projected = YAM::Vector3::Dot(direction, toCenter);
+                const YAM::flt discriminant = sphere.radius * sphere.radius
+                    - (centerDistanceSquared - projected * projected);
+                const YAM::flt distance = projected - std::sqrt(std::max(static_cast<YAM::flt>(0), discriminant));
+                if (distance <= 0.f) {
+                    return false;
+                }
+
+                outSample.direction = direction;
+                outSample.distance = distance;
+                outSample.radiance = materials[light.materialID].GetEmittedLight();
+                outSample.pdf = pickPdf * YAM::SampleWarp::ConePdf(oneMinusCosThetaMax);
+
+                return true;
+            }
+
+            lightPoint = sphere.center + YAM::SampleWarp::SquareToSphere(u, v) * sphere.radius;
+        }
+        else {
+            const TriangleIndices& triangle = triangles[light.primitive];
+
+            YAM::flt barU, barV;
+            YAM::SampleWarp::SquareToTriangle(u, v, barU, barV);
+            lightPoint = positions[triangle.a] + (positions[triangle.b] - positions[triangle.a]) * barU
+                + (positions[triangle.c] - positions[triangle.a]) * barV;
+        }
+
+        const YAM::Vector3 toLight = lightPoint - point;
+        const YAM::flt distanceSquared = YAM::Vector3::Dot(toLight, toLight);
+        if (distanceSquared < YAM::SmallFloat) {
+            return false;
+        }
+
+        outSample.distance = std::sqrt(distanceSquared);
+        outSample.direction = toLight / outSample.distance;
+
+        const YAM::flt lightCos = -YAM::Vector3::Dot(GetLightNormal(light, lightPoint), outSample.direction);
+        if (lightCos <= 0.f) {
+            return false;
+        }
+
+        // Area pdf of the point turned into solid angle at point
+        outSample.radiance = materials[light.materialID].GetEmittedLight();
+        outSample.pdf = pickPdf / light.area * distanceSquared / lightCos;
+
+        return true;
+    }
+
+    YAM::flt Scene::GetLightPdf(uint32_t lightID, const YAM::Vector3& point, const YAM::Vector3& lightPoint) const {
+        const SceneLight& light = lights[lightID];
+
+        // Has to pick the same strategy as SampleLight
+        YAM::flt oneMinusCosThetaMax;
+        if (light.shape == LightShape::Sphere
+            && VisibleCone(spheres[light.primitive].sphere, point, oneMinusCosThetaMax)) {
+            return lightTable.GetPdf(lightID) * YAM::SampleWarp::ConePdf(oneMinusCosThetaMax);
+        }
+
+        const YAM::Vector3 toLight = lightPoint - point;
+        const YAM::flt distanceSquared = YAM::Vector3::Dot(toLight, toLight);
+        if (distanceSquared < YAM::SmallFloat) {
+            return 0.f;
+        }
+
+        const YAM::flt lightCos = -YAM::Vector3::Dot(GetLightNormal(light, lightPoint), toLight)
+            / std::sqrt(distanceSquared);
+        if (lightCos <= 0.f) {
+            return 0.f;
+        }
+
+        return lightTable.GetPdf(lightID) / light.area * distanceSquared / lightCos;
+    }
+
+    YAM::Vector3 Scene::GetLightNormal(const SceneLight& light, const YAM::Vector3& lightPoint) const {
+        if (light.shape == LightShape::Sphere) {
+            const YAM::Sphere& sphere = spheres[light.primitive].sphere;
+            return (lightPoint - sphere.center) / sphere.radius;
+        }
+
+        // Triangles are only hit from the side their winding faces, so they only emit there
+        const TriangleIndices& triangle = triangles[light.primitive];
+        return YAM::Vector3::Cross(positions[triangle.b] - positions[triangle.a],
+                                   positions[triangle.c] - positions[triangle.a]).Normal();
+    }
+
+    template<typename Primitive>
+    bool Scene::TraceAll(const YAM::Ray& ray, const std::vector<Primitive>& primitives, RenderHitInfo& outHit) const {
+        bool wasHit = false;
+        for (const Primitive& primitive : primitives) {
+            wasHit |= TracePrimitive(ray, primitive, outHit);
+        }
+
+        return wasHit;
+    }
+
+    bool Scene::TracePrimitive(const YAM::Ray& ray, const SceneSphere& sphere, RenderHitInfo& outHit) const {
+        YAM::HitInfo hit;
+        if (!YAM::LinearMath::FindIntersection(ray, sphere.sphere, hit) || hit.distance >= outHit.distance) {
+            return false;
+        }
+
+        outHit.hitPoint = hit.hitPoint;
+        outHit.normal = hit.normal;
+        outHit.distance = hit.distance;
+        outHit.materialID = sphere.materialID;
+        outHit.lightID = sphere.lightID;
+
+        return true;
+    }
+
+    bool Scene::TraceMeshes(const YAM::TraversalRay& ray, RenderHitInfo& outHit) const {
+        const YAM::KernelTable& kernels = YAM::Kernels::Get();
+
+        bool wasHit = false;
+        for (uint32_t first = 0; first < meshes.size(); first += BoundsBatchSize) {
+            const uint32_t count = std::min(BoundsBatchSize, static_cast<uint32_t>(meshes.size()) - first);
+
+            uint8_t boundsHits[BoundsBatchSize];
+            if (kernels.intersectBoxes(ray, meshBounds.data() + first, count, boundsHits) == 0) {
+                continue;
+            }
+
+            for (uint32_t i = 0; i < count; ++i) {
+                if (boundsHits[i]) {
+                    wasHit |= TracePrimitive(ray, meshes[first + i], outHit);
+                }
+            }
+        }
+
+        return wasHit;
+    }
+
+    // Bounds were already tested by TraceMeshes
+    bool Scene::TracePrimitive(const YAM::Ray& ray, const SceneMesh& mesh, RenderHitInfo& outHit) const {
+        YAM::TriangleHit closestHit{outHit.distance, 0.f, 0.f};
+        const uint32_t closestTriangle = YAM::Kernels::Get().intersectTriangles(
+            ray, positions.data(), triangles.data() + mesh.firstTriangle, mesh.triangleCount, closestHit);
+
+        if (closestTriangle == std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+
+        const TriangleIndices& tri = triangles[mesh.firstTriangle + closestTriangle];
+        outHit.normal = YAM::LinearMath::InterpolateNormal(normals[tri.a], normals[tri.b], normals[tri.c], closestHit);
+        outHit.hitPoint = ray.point + ray.direction * closestHit.distance;
+        outHit.distance = closestHit.distance;
+        outHit.materialID = mesh.materialID;
+        outHit.lightID = mesh.firstLight == RenderHitInfo::NoLight
+            ? RenderHitInfo::NoLight
+            : mesh.firstLight + closestTriangle;
+
+        return true;
+    }
+
+    bool Scene::TracePrimitive(const YAM::Ray& ray, const SceneRenderable& renderable, RenderHitInfo& outHit) const {
+        RenderHitInfo hit;
+        if (!renderable.renderable->Trace(ray, hit) || hit.distance >= outHit.distance) {
+            return false;
+        }
+
+        outHit = hit;
+        outHit.materialID = renderable.materialID;
+
+        return true;
+    }
+
+    bool Scene::Trace(const YAM::Ray& ray, RenderHitInfo& outHit) const {
+        outHit.distance = std::numeric_limits<YAM::flt>::max();
+        return TraceClosest(ray, outHit);
+    }
+
+    bool Scene::IsOccluded(const YAM::Ray& ray, YAM::flt maxDistance) const {
+        RenderHitInfo hit;
+        hit.distance = maxDistance;
+        return TraceClosest(ray, hit);
+    }
+
+    // Only hits closer than inOutHit.distance count
+    bool Scene::TraceClosest(const YAM::Ray& ray, RenderHitInfo& inOutHit) const {
+        // One tight loop per primitive type, built-in intersections get inlined
+        bool wasHit = TraceAll(ray, spheres, inOutHit);
+        wasHit |= TraceMeshes(YAM::TraversalRay(ray), inOutHit);
+        wasHit |= TraceAll(ray, customRenderables, inOutHit);
+
+        return wasHit;
+    }
+} // YAR
@@ -1,10 +1,21 @@
+#include <cstdlib>
+#include <cstring>
+
 #include "Algorithms.h"
 #include "Camera.h"
 #include "Mat4.h"
+#include "PagedGeometry.h"
 #include "Renderable.h"
 #include "Renderer.h"
+#include "Sampler.h"
 #include "Vector3.h"
 
+// Up to this many samples blue noise previews look cleaner than Sobol, the mask is made by yam_bluenoise
+constexpr uint32_t PreviewSamplesPerPixel = 16;
+
+// Resident budget of --paged when none is given
+constexpr uint64_t DefaultPagedBudgetKiB = 4096;
+
 void CreateCornerBox(YAR::Renderer& renderer) {
     YAR::Material greenMat{};
     greenMat.color.hex = 0xff00ff00;
@@ -66,8 +77,30 @@ void CreateCornerBox(YAR::Renderer& renderer) {
 
 int main(int argc, char* argv[]) {
     uint32_t resX = 512, resY = 512;
+
+    // --paged [budget KiB] adds the plumber out of core, streamed into a PagedGeometryStore
+    std::shared_ptr<YAR::PagedGeometryStore> pagedStore;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--paged") != 0) {
+            continue;
+        }
+
+        uint64_t budgetKiB = DefaultPagedBudgetKiB;
+        if (i + 1 < argc && std::strtoull(argv[i + 1], nullptr, 10) > 0) {
+            budgetKiB = std::strtoull(argv[++i], nullptr, 10);
+        }
+
+        pagedStore = std::make_shared<YAR::PagedGeometryStore>("geometry.cache", budgetKiB * 1024);
+    }
     
     YAR::Renderer renderer{resX, resY, 256, 10, 8};
+
+    if (renderer.GetSamplesPerPixel() <= PreviewSamplesPerPixel) {
+        std::shared_ptr<YAM::BlueNoiseMask> mask = std::make_shared<YAM::BlueNoiseMask>();
+        if (YAM::BlueNoiseMask::Load("res/blueNoise64.bin", *mask)) {
+            renderer.SetSampler(std::make_shared<YAM::BlueNoiseSampler>(mask, YAR::Renderer::RenderSeed));
+        }
+    }
     
     YAR::Material sphereOneMat{};
     sphereOneMat.color.hex = 0xffffffff;
@@ -101,6 +134,16 @@ int main(int argc, char* argv[]) {
     // renderable->Transform(transform);
     // renderer.AddRenderable(renderable);
 
+    if (pagedStore) {
+        YAR::Material pagedMaterial{};
+        pagedMaterial.color.hex = 0xffffffff;
+
+        const YAM::Mat4 pagedT = YAM::Mat4::Translation(0.0f, -0.5f, -0.5f) * YAM::Mat4::RotationY(YAM::ToRad(180.f))
+            * YAM::Mat4::Scale(0.2f, 0.2f, 0.2f);
+        renderer.AddRenderable(std::make_shared<YAR::PagedMeshRenderable>(pagedMaterial, "res/plumber.obj", pagedT,
+                                                                           pagedStore));
+    }
+
     CreateCornerBox(renderer);
     
     YAM::Vector3 cameraPosition(0.f, 0.f, -3.f);
@@ -112,6 +155,11 @@ int main(int argc, char* argv[]) {
     std::shared_ptr<YAR::Camera> camera = std::make_shared<YAR::PerspectiveCamera>(
         resX, resY, cameraPosition, cameraDirection, 1.f );
 
+    renderer.GetScene().Commit();
     renderer.Render(camera);
     renderer.Save("res/output/output.tga");
+
+    if (pagedStore) {
+        pagedStore->LogStats();
+    }
 }
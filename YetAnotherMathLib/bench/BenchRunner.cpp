@@ -0,0 +1,123 @@
+#include "BenchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace YAM{
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        double ElapsedMs(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        double RunCalls(const std::function<void()>& body, uint64_t calls) {
+            const Clock::time_point start = Clock::now();
+            for (uint64_t i = 0; i < calls; ++i) {
+                body();
+            }
+            return ElapsedMs(start);
+        }
+
+        // Names are plain identifiers, only quotes and backslashes need escaping
+        std::string Quote(const std::string& text) {
+            std::string result = "\"";
+            for (const char c : text) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                }
+                result += c;
+            }
+            return result + "\"";
+        }
+    }
+
+    BenchRunner::BenchRunner(const BenchSettings& settings)
+        : settings(settings) {}
+
+    void BenchRunner::Add(const std::string& name, uint32_t itemsPerCall, std::function<void()> body) {
+        if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos) {
+            return;
+        }
+
+        benchmarks.push_back({name, itemsPerCall, std::move(body)});
+    }
+
+    BenchResult BenchRunner::Measure(const Benchmark& benchmark) const {
+        // Warms caches, branch predictors and the clock speed
+        const Clock::time_point warmupStart = Clock::now();
+        do {
+            benchmark.body();
+        } while (ElapsedMs(warmupStart) < settings.warmupMs);
+
+        // Doubles the call count until a repetition is long enough to time reliably
+        uint64_t calls = 1;
+        while (RunCalls(benchmark.body, calls) < settings.minRepetitionMs) {
+            calls *= 2;
+        }
+
+        BenchResult result{benchmark.name, benchmark.itemsPerCall, calls, {}, 0., 0., 0., 0.};
+        const double itemsPerRepetition = static_cast<double>(calls) * benchmark.itemsPerCall;
+        for (uint32_t i = 0; i < settings.repetitions; ++i) {
+            result.samples.push_back(RunCalls(benchmark.body, calls) * 1e6 / itemsPerRepetition);
+        }
+
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t count = sorted.size();
+
+        result.min = sorted.front();
+        result.median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.;
+        result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.) / count;
+
+        double variance = 0.;
+        for (const double sample : sorted) {
+            variance += (sample - result.mean) * (sample - result.mean);
+        }
+        result.stddev = count > 1 ? std::sqrt(variance / (count - 1)) : 0.;
+
+        return result;
+    }
+
+    void BenchRunner::Run() {
+        results.clear();
+        for (const Benchmark& benchmark : benchmarks) {
+            results.push_back(Measure(benchmark));
+
+            const BenchResult& result = results.back();
+            std::fprintf(stderr, "%-40s %10.3f ns/item (+- %.1f%%)\n", result.name.c_str(), result.median,
+                         result.mean > 0. ? 100. * result.stddev / result.mean : 0.);
+        }
+    }
+
+    void BenchRunner::WriteJson(std::ostream& os,
+                                const std::vector<std::pair<std::string, std::string>>& context) const {
+        os << "{\n  \"context\": {\n";
+        for (size_t i = 0; i < context.size(); ++i) {
+            os << "    " << Quote(context[i].first) << ": " << Quote(context[i].second);
+            os << (i + 1 < context.size() ? ",\n" : "\n");
+        }
+        os << "  },\n  \"benchmarks\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& result = results[i];
+            os << "    {\n";
+            os << "      \"name\": " << Quote(result.name) << ",\n";
+            os << "      \"items_per_call\": " << result.itemsPerCall << ",\n";
+            os << "      \"calls_per_repetition\": " << result.callsPerRepetition << ",\n";
+            os << "      \"ns_per_item\": {\"min\": " << result.min << ", \"median\": " << result.median
+                << ", \"mean\": " << result.mean << ", \"stddev\": " << result.stddev << "},\n";
+            os << "      \"items_per_second\": " << (result.median > 0. ? 1e9 / result.median : 0.) << ",\n";
+            os << "      \"samples\": [";
+            for (size_t j = 0; j < result.samples.size(); ++j) {
+                os << (j ? ", " : "") << result.samples[j];
+            }
+            os << "]\n    }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+
+        os << "  ]\n}\n";
+    }
+}
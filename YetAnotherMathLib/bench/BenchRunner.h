@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace YAM{
+    // Keeps the compiler from dropping a result nobody reads
+    template<typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        const volatile char* bytes = reinterpret_cast<const volatile char*>(&value);
+        (void)*bytes;
+#endif
+    }
+
+    struct BenchSettings {
+        // Only benchmarks whose name contains it run, empty runs everything
+        std::string filter;
+        uint32_t repetitions = 10;
+        double warmupMs = 50.;
+        // Every repetition runs at least this long, the iteration count is calibrated once
+        double minRepetitionMs = 20.;
+    };
+
+    // ns per item of every repetition and their statistics
+    struct BenchResult {
+        std::string name;
+        uint32_t itemsPerCall;
+        uint64_t callsPerRepetition;
+        std::vector<double> samples;
+
+        double min;
+        double median;
+        double mean;
+        double stddev;
+    };
+
+    // Times registered bodies one after another. A body processes itemsPerCall items,
+    // throughput is reported per item so batched and single calls compare directly.
+    class BenchRunner {
+    private:
+        struct Benchmark {
+            std::string name;
+            uint32_t itemsPerCall;
+            std::function<void()> body;
+        };
+
+        BenchSettings settings;
+        std::vector<Benchmark> benchmarks;
+        std::vector<BenchResult> results;
+
+        BenchResult Measure(const Benchmark& benchmark) const;
+
+    public:
+        explicit BenchRunner(const BenchSettings& settings);
+
+        void Add(const std::string& name, uint32_t itemsPerCall, std::function<void()> body);
+
+        // Progress goes to stderr, so stdout can carry the JSON
+        void Run();
+
+        // context holds extra key/value strings describing the build and the machine
+        void WriteJson(std::ostream& os, const std::vector<std::pair<std::string, std::string>>& context) const;
+    };
+}
@@ -0,0 +1,545 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Algorithms.h"
+#include "BenchRunner.h"
+#include "CpuFeatures.h"
+#include "Kernels.h"
+#include "LinearMath.h"
+#include "Mat3x4.h"
+#include "Mat4.h"
+#include "Quaternion.h"
+#include "RigidTransform.h"
+#include "Sampler.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace {
+    // Inputs are regenerated from this seed for every benchmark, so results do not
+    // depend on which benchmarks run or in what order
+    constexpr uint32_t Seed = 0x59414d42u;
+
+    // Items per call, enough to amortize the call without leaving L1
+    constexpr uint32_t BatchSize = 1024;
+
+    YAM::flt RandRange(const YAM::Random& random, YAM::flt min, YAM::flt max) {
+        return min + (max - min) * random.RandFloat();
+    }
+
+    YAM::Vector3 RandVector(const YAM::Random& random, YAM::flt extent) {
+        return {RandRange(random, -extent, extent), RandRange(random, -extent, extent),
+                RandRange(random, -extent, extent)};
+    }
+
+    // Rays from a box around the origin pointing roughly at it, so about half of the tests hit
+    std::vector<YAM::Ray> MakeRays(const YAM::Random& random) {
+        std::vector<YAM::Ray> rays;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            const YAM::Vector3 point = RandVector(random, 4) + YAM::Vector3{0, 0, -6};
+            const YAM::Vector3 target = RandVector(random, 1);
+            rays.push_back(YAM::Ray::FromTwoPoints(point, target));
+        }
+        return rays;
+    }
+
+    std::vector<YAM::Vector3> MakeVectors(const YAM::Random& random) {
+        std::vector<YAM::Vector3> vectors;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            vectors.push_back(RandVector(random, 1));
+        }
+        return vectors;
+    }
+
+    YAM::Mat4 MakeMatrix(const YAM::Random& random) {
+        return YAM::Mat4::Translation(RandRange(random, -1, 1), RandRange(random, -1, 1), RandRange(random, -1, 1))
+            * YAM::Mat4::RotationY(RandRange(random, 0, 6)) * YAM::Mat4::RotationX(RandRange(random, 0, 6))
+            * YAM::Mat4::Scale(RandRange(random, 0.5f, 2), RandRange(random, 0.5f, 2), RandRange(random, 0.5f, 2));
+    }
+
+    void AddVectorBenchmarks(YAM::BenchRunner& runner) {
+        const YAM::Random random(Seed);
+        const std::vector<YAM::Vector3> a = MakeVectors(random);
+        const std::vector<YAM::Vector3> b = MakeVectors(random);
+
+        runner.Add("Vector3/Add", BatchSize, [a, b] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a[i] + b[i]);
+            }
+        });
+        runner.Add("Vector3/MulScalar", BatchSize, [a] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a[i] * static_cast<YAM::flt>(1.5));
+            }
+        });
+        runner.Add("Vector3/Dot", BatchSize, [a, b] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a[i].Dot(b[i]));
+            }
+        });
+        runner.Add("Vector3/Cross", BatchSize, [a, b] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a[i].Cross(b[i]));
+            }
+        });
+        runner.Add("Vector3/Normal", BatchSize, [a] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a[i].Normal());
+            }
+        });
+
+        std::vector<YAM::Vector4> a4;
+        std::vector<YAM::Vector4> b4;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            a4.emplace_back(a[i], 1);
+            b4.emplace_back(b[i], 0);
+        }
+
+        runner.Add("Vector4/Add", BatchSize, [a4, b4] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a4[i] + b4[i]);
+            }
+        });
+        runner.Add("Vector4/Mul", BatchSize, [a4, b4] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(a4[i].Mul(b4[i]));
+            }
+        });
+    }
+
+    void AddMatrixBenchmarks(YAM::BenchRunner& runner) {
+        const YAM::Random random(Seed);
+        std::vector<YAM::Mat4> matrices;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            matrices.push_back(MakeMatrix(random));
+        }
+
+        runner.Add("Mat4/Multiply", BatchSize, [matrices] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(matrices[i] * matrices[BatchSize - 1 - i]);
+            }
+        });
+        runner.Add("Mat4/Inverse", BatchSize, [matrices] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(matrices[i].Inverse());
+            }
+        });
+        runner.Add("Mat4/Transpose", BatchSize, [matrices] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(matrices[i].Transpose());
+            }
+        });
+
+        const std::vector<YAM::Vector3> points = MakeVectors(random);
+        runner.Add("Mat4/MulVector4", BatchSize, [matrices, points] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(matrices[0] * YAM::Vector4{points[i], 1});
+            }
+        });
+
+        std::vector<YAM::Vector3> outPoints(BatchSize);
+        runner.Add("Mat4/TransformPoints", BatchSize, [matrices, points, outPoints]() mutable {
+            YAM::Mat4::TransformPoints(matrices[0], points.data(), outPoints.data(), BatchSize);
+            YAM::DoNotOptimize(outPoints[0]);
+        });
+        runner.Add("Mat4/TransformNormals", BatchSize, [matrices, points, outPoints]() mutable {
+            YAM::Mat4::TransformNormals(matrices[0], points.data(), outPoints.data(), BatchSize);
+            YAM::DoNotOptimize(outPoints[0]);
+        });
+
+        // Same transforms without the constant last row
+        std::vector<YAM::Mat3x4> affines;
+        for (const YAM::Mat4& matrix : matrices) {
+            affines.emplace_back(matrix);
+        }
+
+        runner.Add("Mat3x4/Multiply", BatchSize, [affines] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(affines[i] * affines[BatchSize - 1 - i]);
+            }
+        });
+        runner.Add("Mat3x4/Inverse", BatchSize, [affines] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(affines[i].Inverse());
+            }
+        });
+        runner.Add("Mat3x4/TransformPoints", BatchSize, [affines, points, outPoints]() mutable {
+            YAM::Mat3x4::TransformPoints(affines[0], points.data(), outPoints.data(), BatchSize);
+            YAM::DoNotOptimize(outPoints[0]);
+        });
+        runner.Add("Mat3x4/TransformNormals", BatchSize, [affines, points, outPoints]() mutable {
+            YAM::Mat3x4::TransformNormals(affines[0], points.data(), outPoints.data(), BatchSize);
+            YAM::DoNotOptimize(outPoints[0]);
+        });
+    }
+
+    void AddTransformBenchmarks(YAM::BenchRunner& runner) {
+        const YAM::Random random(Seed);
+        std::vector<YAM::RigidTransform> transforms;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            const YAM::Quaternion rotation = YAM::Quaternion::FromAxisAngle(RandVector(random, 1), RandRange(random, 0, 6));
+            transforms.emplace_back(rotation, RandVector(random, 1), RandRange(random, 0.5f, 2));
+        }
+        const std::vector<YAM::Vector3> points = MakeVectors(random);
+
+        runner.Add("Quaternion/Multiply", BatchSize, [transforms] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(transforms[i].rotation * transforms[BatchSize - 1 - i].rotation);
+            }
+        });
+        runner.Add("Quaternion/Rotate", BatchSize, [transforms, points] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(transforms[i].rotation.Rotate(points[i]));
+            }
+        });
+        runner.Add("Quaternion/Slerp", BatchSize, [transforms] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(YAM::Quaternion::Slerp(transforms[i].rotation, transforms[BatchSize - 1 - i].rotation,
+                                                          static_cast<YAM::flt>(0.3)));
+            }
+        });
+        runner.Add("RigidTransform/TransformPoint", BatchSize, [transforms, points] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(transforms[i].TransformPoint(points[i]));
+            }
+        });
+        runner.Add("RigidTransform/Compose", BatchSize, [transforms] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(transforms[i] * transforms[BatchSize - 1 - i]);
+            }
+        });
+        runner.Add("RigidTransform/Inverse", BatchSize, [transforms] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(transforms[i].Inverse());
+            }
+        });
+    }
+
+    // One benchmark per LinearMath::FindIntersection overload
+    void AddIntersectionBenchmarks(YAM::BenchRunner& runner) {
+        const YAM::Random random(Seed);
+        const std::vector<YAM::Ray> rays = MakeRays(random);
+        const std::vector<YAM::Ray> otherRays = MakeRays(random);
+
+        runner.Add("FindIntersection/RayRay", BatchSize, [rays, otherRays] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::Vector3 result;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], otherRays[i], result));
+                YAM::DoNotOptimize(result);
+            }
+        });
+
+        std::vector<YAM::Plane> planes;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            const YAM::Vector3 normal = RandVector(random, 1).Normal();
+            planes.push_back(YAM::Plane::FromGeneral(normal.x, normal.y, normal.z, RandRange(random, -1, 1)));
+        }
+
+        runner.Add("FindIntersection/RayPlane", BatchSize, [rays, planes] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::Vector3 result;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], planes[i], result));
+                YAM::DoNotOptimize(result);
+            }
+        });
+        runner.Add("FindIntersection/PlanePlane", BatchSize, [rays, planes] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::Ray result = rays[i];
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(planes[i], planes[BatchSize - 1 - i], result));
+                YAM::DoNotOptimize(result);
+            }
+        });
+
+        std::vector<YAM::Segment> segments;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            segments.emplace_back(RandVector(random, 1), RandVector(random, 1));
+        }
+
+        runner.Add("FindIntersection/SegmentSegment", BatchSize, [segments] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::Vector3 result;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(segments[i], segments[BatchSize - 1 - i], result));
+                YAM::DoNotOptimize(result);
+            }
+        });
+
+        std::vector<YAM::Sphere> spheres;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            spheres.push_back({RandVector(random, 1), RandRange(random, 0.1f, 0.5f)});
+        }
+
+        runner.Add("FindIntersection/RaySphere", BatchSize, [rays, spheres] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::HitInfo hit;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], spheres[i], hit));
+                YAM::DoNotOptimize(hit);
+            }
+        });
+
+        // Triangles facing the rays, so the culling test does not reject most of them
+        std::vector<YAM::Triangle> triangles;
+        for (uint32_t i = 0; i < BatchSize; ++i) {
+            const YAM::Vector3 center = RandVector(random, 1);
+            const YAM::Vector3 normal = RandVector(random, 1).Normal();
+            triangles.emplace_back(center + YAM::Vector3{-1, -1, 0}, center + YAM::Vector3{1, -1, 0},
+                                   center + YAM::Vector3{0, 1, 0}, normal, normal, normal);
+        }
+
+        runner.Add("FindIntersection/RayTriangle", BatchSize, [rays, triangles] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::HitInfo hit;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], triangles[i], hit));
+                YAM::DoNotOptimize(hit);
+            }
+        });
+        runner.Add("FindIntersection/RayTriangleVertices", BatchSize, [rays, triangles] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                const YAM::Triangle& tri = triangles[i];
+                YAM::HitInfo hit;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], tri.posA, tri.posB, tri.posC,
+                                                                     tri.norA, tri.norB, tri.norC, hit));
+                YAM::DoNotOptimize(hit);
+            }
+        });
+        runner.Add("FindIntersection/RayTrianglePositions", BatchSize, [rays, triangles] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                const YAM::Triangle& tri = triangles[i];
+                YAM::TriangleHit hit{};
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], tri.posA, tri.posB, tri.posC, hit));
+                YAM::DoNotOptimize(hit);
+            }
+        });
+
+        std::vector<YAM::AABB> boxes(BatchSize);
+        for (YAM::AABB& box : boxes) {
+            const YAM::Vector3 center = RandVector(random, 1);
+            const YAM::Vector3 extent = YAM::Vector3{RandRange(random, 0.1f, 0.5f)};
+            box.min = center - extent;
+            box.max = center + extent;
+        }
+
+        runner.Add("FindIntersection/RayAABB", BatchSize, [rays, boxes] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(rays[i], boxes[i]));
+            }
+        });
+
+        std::vector<YAM::TraversalRay> traversalRays;
+        for (const YAM::Ray& ray : rays) {
+            traversalRays.emplace_back(ray);
+        }
+
+        runner.Add("FindIntersection/TraversalRayAABB", BatchSize, [traversalRays, boxes] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(traversalRays[i], boxes[i]));
+            }
+        });
+        runner.Add("FindIntersection/TraversalRayAABBEntry", BatchSize, [traversalRays, boxes] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::flt entry;
+                YAM::DoNotOptimize(YAM::LinearMath::FindIntersection(traversalRays[i], boxes[i], entry));
+                YAM::DoNotOptimize(entry);
+            }
+        });
+
+        // The batched version of the box test, one ray against every box
+        std::vector<uint8_t> hits(BatchSize);
+        runner.Add("Kernels/IntersectBoxes", BatchSize, [traversalRays, boxes, hits]() mutable {
+            YAM::DoNotOptimize(YAM::Kernels::Get().intersectBoxes(traversalRays[0], boxes.data(), BatchSize,
+                                                                   hits.data()));
+        });
+    }
+
+    void AddRandomBenchmarks(YAM::BenchRunner& runner) {
+        const YAM::Random random(Seed);
+        const YAM::Vector3 normal = YAM::Vector3{1, 2, 3}.Normal();
+
+        runner.Add("Random/RandInt", BatchSize, [random] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandInt());
+            }
+        });
+        runner.Add("Random/RandFloat", BatchSize, [random] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandFloat());
+            }
+        });
+        runner.Add("Random/RandFloatNormal", BatchSize, [random] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandFloatNormal());
+            }
+        });
+        runner.Add("Random/RandomPointInCircle", BatchSize, [random] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::flt x, y;
+                random.RandomPointInCircle(x, y);
+                YAM::DoNotOptimize(x);
+                YAM::DoNotOptimize(y);
+            }
+        });
+        runner.Add("Random/RandomDirection", BatchSize, [random] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandomDirection());
+            }
+        });
+        runner.Add("Random/RandomHemisphereDirection", BatchSize, [random, normal] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandomHemisphereDirection(normal));
+            }
+        });
+        runner.Add("Random/RandomCosineHemisphereDirection", BatchSize, [random, normal] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(random.RandomCosineHemisphereDirection(normal));
+            }
+        });
+
+        std::vector<YAM::flt> values(BatchSize);
+        runner.Add("Random/FillFloats", BatchSize, [random, values]() mutable {
+            random.FillFloats(values.data(), BatchSize);
+            YAM::DoNotOptimize(values[0]);
+        });
+
+        const YAM::CounterRandom counterRandom(Seed, 0, 0);
+        runner.Add("CounterRandom/RandInt", BatchSize, [counterRandom] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(counterRandom.RandInt());
+            }
+        });
+        runner.Add("CounterRandom/RandFloat", BatchSize, [counterRandom] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                YAM::DoNotOptimize(counterRandom.RandFloat());
+            }
+        });
+        std::vector<uint32_t> ints(BatchSize);
+        runner.Add("CounterRandom/FillInts", BatchSize, [counterRandom, ints]() mutable {
+            counterRandom.FillInts(ints.data(), BatchSize);
+            YAM::DoNotOptimize(ints[0]);
+        });
+        runner.Add("CounterRandom/FillFloats", BatchSize, [counterRandom, values]() mutable {
+            counterRandom.FillFloats(values.data(), BatchSize);
+            YAM::DoNotOptimize(values[0]);
+        });
+
+        // One stream per pixel sample, as the renderer builds them
+        runner.Add("CounterRandom/NewStream", BatchSize, [] {
+            for (uint32_t i = 0; i < BatchSize; ++i) {
+                const YAM::CounterRandom stream(Seed, i, 0);
+                YAM::DoNotOptimize(stream.RandInt());
+            }
+        });
+    }
+
+    void AddSamplerBenchmarks(YAM::BenchRunner& runner) {
+        // Camera jitter plus four bounces per pixel sample
+        const auto addSampler = [&runner](const char* name, std::shared_ptr<const YAM::Sampler> sampler) {
+            runner.Add(name, BatchSize, [sampler] {
+                for (uint32_t i = 0; i < BatchSize; ++i) {
+                    sampler->StartPixelSample(i & 63, i >> 6, i);
+                    for (uint32_t dimension = 0; dimension < 5; ++dimension) {
+                        YAM::flt u, v;
+                        sampler->Get2D(u, v);
+                        YAM::DoNotOptimize(u);
+                        YAM::DoNotOptimize(v);
+                    }
+                }
+            });
+        };
+
+        addSampler("Sampler/Random", std::make_shared<YAM::RandomSampler>(Seed));
+        addSampler("Sampler/Sobol", std::make_shared<YAM::SobolSampler>(Seed));
+
+        // Cost does not depend on the mask contents, any permutation will do
+        std::vector<uint16_t> ranks(64 * 64 * 2);
+        for (uint32_t i = 0; i < ranks.size(); ++i) {
+            ranks[i] = static_cast<uint16_t>(i & 4095);
+        }
+        const auto mask = std::make_shared<YAM::BlueNoiseMask>(64, 2, std::move(ranks));
+        addSampler("Sampler/BlueNoise", std::make_shared<YAM::BlueNoiseSampler>(mask, Seed));
+    }
+
+    bool ParseArgument(const char* argument, const char* name, const char*& outValue) {
+        const size_t length = std::strlen(name);
+        if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') {
+            return false;
+        }
+
+        outValue = argument + length + 1;
+        return true;
+    }
+
+    const char* SimdBackend() {
+#if defined(YAM_SIMD_SSE)
+        return "SSE";
+#elif defined(YAM_SIMD_NEON)
+        return "NEON";
+#else
+        return "None";
+#endif
+    }
+}
+
+// yam_bench [--filter=<substring>] [--repetitions=<n>] [--min-time-ms=<ms>] [--isa=<level>] [--out=<file>]
+int main(int argc, char* argv[]) {
+    YAM::BenchSettings settings;
+    const char* outPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (ParseArgument(argv[i], "--filter", value)) {
+            settings.filter = value;
+        }
+        else if (ParseArgument(argv[i], "--repetitions", value)) {
+            settings.repetitions = std::max(1, std::atoi(value));
+        }
+        else if (ParseArgument(argv[i], "--min-time-ms", value)) {
+            settings.minRepetitionMs = std::atof(value);
+        }
+        else if (ParseArgument(argv[i], "--isa", value)) {
+            YAM::IsaLevel level;
+            if (!YAM::CpuFeatures::FromString(value, level)) {
+                std::cerr << "Unknown instruction set " << value << "\n";
+                return 1;
+            }
+            YAM::CpuFeatures::SetLevel(level);
+        }
+        else if (ParseArgument(argv[i], "--out", value)) {
+            outPath = value;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0]
+                << " [--filter=<substring>] [--repetitions=<n>] [--min-time-ms=<ms>] [--isa=<level>] [--out=<file>]\n";
+            return 1;
+        }
+    }
+
+    YAM::BenchRunner runner(settings);
+    AddVectorBenchmarks(runner);
+    AddMatrixBenchmarks(runner);
+    AddTransformBenchmarks(runner);
+    AddIntersectionBenchmarks(runner);
+    AddRandomBenchmarks(runner);
+    AddSamplerBenchmarks(runner);
+    runner.Run();
+
+    const std::vector<std::pair<std::string, std::string>> context = {
+        {"isa", YAM::CpuFeatures::ToString(YAM::CpuFeatures::GetLevel())},
+        {"simd", SimdBackend()},
+        {"precision", sizeof(YAM::flt) == sizeof(double) ? "double" : "float"},
+        {"build_type", YAM_BENCH_BUILD_TYPE},
+        {"seed", std::to_string(Seed)},
+        {"repetitions", std::to_string(settings.repetitions)},
+    };
+
+    if (outPath) {
+        std::ofstream file(outPath);
+        runner.WriteJson(file, context);
+    }
+    else {
+        runner.WriteJson(std::cout, context);
+    }
+
+    return 0;
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
 #include "Defines.h"
+#include "FastMath.h"
+#include "Kernels.h"
 #include "LinearMath.h"
 #include "Vector3.h"
 
@@ -15,7 +18,158 @@ namespace YAM{
     public:
     };
 
-    class Random {
+    // Maps uniform points of the unit square onto the domains sampling needs. Each costs one SinCos
+    // and at most one sqrt, and strata of the square stay compact, so stratified samplers keep
+    // their advantage after the mapping.
+    class SampleWarp {
+    public:
+        // Uniform point on the unit disk, concentric mapping (Shirley and Chiu 1997)
+        static void SquareToDisk(flt u, flt v, flt& outX, flt& outY) {
+            const flt a = 2.f * u - 1.f;
+            const flt b = 2.f * v - 1.f;
+
+            if (a == 0.f && b == 0.f) {
+                outX = 0.f;
+                outY = 0.f;
+                return;
+            }
+
+            // Squares around the center map to rings, the larger coordinate is the radius
+            constexpr flt quarterPi = static_cast<flt>(M_PI / 4.);
+            flt radius, angle;
+            if (std::abs(a) > std::abs(b)) {
+                radius = a;
+                angle = quarterPi * (b / a);
+            }
+            else {
+                radius = b;
+                angle = 2.f * quarterPi - quarterPi * (a / b);
+            }
+
+            flt sin, cos;
+            Transcendentals::SinCos(angle, sin, cos);
+
+            outX = radius * cos;
+            outY = radius * sin;
+        }
+
+        // Uniform direction on the unit sphere, z is uniform in [-1, 1] (Archimedes)
+        static Vector3 SquareToSphere(flt u, flt v) {
+            const flt z = 1.f - 2.f * u;
+            const flt radius = std::sqrt(std::max(static_cast<flt>(0), 1.f - z * z));
+
+            flt sin, cos;
+            Transcendentals::SinCos(v * static_cast<flt>(2. * M_PI), sin, cos);
+
+            return {radius * cos, radius * sin, z};
+        }
+
+        // Cosine weighted direction around normal, a disk point lifted onto the hemisphere (Malley)
+        static Vector3 SquareToCosineHemisphere(flt u, flt v, const Vector3& normal) {
+            flt x, y;
+            SquareToDisk(u, v, x, y);
+            const flt z = std::sqrt(std::max(static_cast<flt>(0), 1.f - x * x - y * y));
+
+            Vector3 tangent, bitangent;
+            TangentFrame(normal, tangent, bitangent);
+
+            return tangent * x + bitangent * y + normal * z;
+        }
+
+        // Uniform direction in the cone around a unit axis whose half angle has the given 1 - cos.
+        // Taking 1 - cos rather than cos keeps narrow cones, like distant sphere lights, precise.
+        static Vector3 SquareToCone(flt u, flt v, flt oneMinusCosThetaMax, const Vector3& axis) {
+            const flt oneMinusCos = u * oneMinusCosThetaMax;
+            const flt cosTheta = 1.f - oneMinusCos;
+            const flt sinTheta = std::sqrt(std::max(static_cast<flt>(0), oneMinusCos * (2.f - oneMinusCos)));
+
+            flt sin, cos;
+            Transcendentals::SinCos(v * static_cast<flt>(2. * M_PI), sin, cos);
+
+            Vector3 tangent, bitangent;
+            TangentFrame(axis, tangent, bitangent);
+
+            return tangent * (sinTheta * cos) + bitangent * (sinTheta * sin) + axis * cosTheta;
+        }
+
+        // Uniform point on a triangle as the barycentrics of vertices B and C, like TriangleHit
+        static void SquareToTriangle(flt u, flt v, flt& outBarU, flt& outBarV) {
+            const flt root = std::sqrt(u);
+            outBarU = root * (1.f - v);
+            outBarV = root * v;
+        }
+
+        // Pdf of SquareToCosineHemisphere over solid angle
+        static flt CosineHemispherePdf(flt cosTheta) {
+            return std::max(static_cast<flt>(0), cosTheta) * static_cast<flt>(1. / M_PI);
+        }
+
+        // Pdf of SquareToCone over solid angle
+        static flt ConePdf(flt oneMinusCosThetaMax) {
+            return static_cast<flt>(1. / (2. * M_PI)) / oneMinusCosThetaMax;
+        }
+
+        // Orthonormal basis around a unit normal without a branch on its direction
+        // (Duff et al., "Building an Orthonormal Basis, Revisited", JCGT 2017)
+        static void TangentFrame(const Vector3& normal, Vector3& outTangent, Vector3& outBitangent) {
+            const flt sign = std::copysign(static_cast<flt>(1), normal.z);
+            const flt a = -1.f / (sign + normal.z);
+            const flt b = normal.x * normal.y * a;
+
+            outTangent = {1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x};
+            outBitangent = {b, sign + normal.y * normal.y * a, -normal.y};
+        }
+    };
+
+    // Distributions over uniform 32 bit integers, shared by the generators below.
+    // Generator provides uint32_t RandInt() const.
+    template<typename Generator>
+    class RandomDistributions {
+    public:
+        void RandomPointInCircle(flt& x, flt& y) const {
+            const flt u = RandFloat();
+            SampleWarp::SquareToDisk(u, RandFloat(), x, y);
+        }
+
+        // Uniform over the hemisphere around normal
+        Vector3 RandomHemisphereDirection(const Vector3& normal) const {
+            const Vector3 result = RandomDirection();
+
+            if (normal.Dot(result) < 0.f) {
+                return result * -1.f;
+            }
+
+            return result;
+        }
+
+        Vector3 RandomCosineHemisphereDirection(const Vector3& normal) const {
+            const flt u = RandFloat();
+            return SampleWarp::SquareToCosineHemisphere(u, RandFloat(), normal);
+        }
+
+        Vector3 RandomDirection() const {
+            const flt u = RandFloat();
+            return SampleWarp::SquareToSphere(u, RandFloat());
+        }
+
+        flt RandFloatNormal() const {
+            const flt theta = static_cast<flt>(2. * M_PI) * RandFloat();
+            const flt rho = std::sqrt(-2.f * Transcendentals::Log(RandFloat()));
+
+            return rho * Transcendentals::Cos(theta);
+        }
+
+        static constexpr flt one_randMax = 1. / 0xFFFFFFFFU;
+
+        flt RandFloat() const {
+            return static_cast<flt>(Self().RandInt()) * one_randMax;
+        }
+
+    private:
+        const Generator& Self() const { return static_cast<const Generator&>(*this); }
+    };
+
+    class Random : public RandomDistributions<Random> {
     private:
         mutable uint32_t seed;
 
@@ -42,49 +196,103 @@ namespace YAM{
             return seed;
         }
 
-        void RandomPointInCircle(flt& x, flt& y) const {
-            const flt angle = RandFloat() * 2. * M_PI;
-            const flt radius = std::sqrt(RandFloat());
-            
-            x = radius * std::cos(angle);
-            y = radius * std::sin(angle);
+        // Batches through the dispatched kernels, CounterRandom hashes keyed by the next RandInt().
+        // Both advance the seed once.
+        void FillInts(uint32_t* out, uint32_t count) const {
+            Kernels::Get().fillRandomInts(RandInt(), 0, out, count);
         }
 
-        Vector3 RandomHemisphereDirection(const Vector3& normal) const {
-            Vector3 result;
-            result.x = RandFloatNormal();
-            result.y = RandFloatNormal();
-            result.z = RandFloatNormal();
+        // Uniform floats in [0, 1)
+        void FillFloats(flt* out, uint32_t count) const {
+            Kernels::Get().fillRandom(RandInt(), 0, out, count);
+        }
+    };
 
-            result = result.Normal();
+    // Stateless counter based generator. Value i of a stream is a hash of the render seed, pixel,
+    // sample index, bounce and dimension i, so any random number of any path can be regenerated
+    // on its own and renders do not depend on tiling or thread count.
+    class CounterRandom : public RandomDistributions<CounterRandom> {
+    private:
+        uint32_t seed;
+        uint32_t pixel;
+        uint32_t sampleIndex;
+        uint32_t bounce;
+        // Hash of everything above, so drawing a number costs two PCG rounds
+        uint32_t streamKey;
 
-            if (normal.Dot(result) < 0.f) {
-                return result * -1.f;
-            }
+        mutable uint32_t dimension;
 
-            return result;
+    public:
+        CounterRandom(uint32_t seed, uint32_t pixel, uint32_t sampleIndex, uint32_t bounce = 0)
+            : seed(seed)
+              , pixel(pixel)
+              , sampleIndex(sampleIndex)
+              , bounce(bounce)
+              , streamKey(Key(seed, pixel, sampleIndex, bounce))
+              , dimension(0) {}
+
+        // Starts the stream of another bounce of the same path at dimension 0
+        void SetBounce(uint32_t newBounce) {
+            bounce = newBounce;
+            streamKey = Key(seed, pixel, sampleIndex, bounce);
+            dimension = 0;
         }
-        
-        Vector3 RandomDirection() const {
-            Vector3 result;
-            result.x = RandFloatNormal();
-            result.y = RandFloatNormal();
-            result.z = RandFloatNormal();
 
-            return result.Normal();
+        uint32_t GetBounce() const { return bounce; }
+        uint32_t GetDimension() const { return dimension; }
+        void SetDimension(uint32_t newDimension) const { dimension = newDimension; }
+
+        // Next dimension of the stream
+        uint32_t RandInt() const {
+            return At(dimension++);
         }
 
-        flt RandFloatNormal() const {
-            const flt theta = 2.f * M_PI * RandFloat();
-            const flt rho = std::sqrt(-2.f * std::log(RandFloat()));
+        // Any dimension without advancing the stream
+        uint32_t At(uint32_t index) const {
+            return Hash(streamKey, index);
+        }
 
-            return rho * std::cos(theta);
+        // The next count dimensions at once, 8 lanes per instruction with AVX2. Ints match RandInt()
+        // value for value, floats keep the top 24 bits so they stay below 1.
+        void FillInts(uint32_t* out, uint32_t count) const {
+            Kernels::Get().fillRandomInts(streamKey, dimension, out, count);
+            dimension += count;
         }
 
-        static constexpr flt one_randMax = 1. / 0xFFFFFFFFU;
+        void FillFloats(flt* out, uint32_t count) const {
+            Kernels::Get().fillRandom(streamKey, dimension, out, count);
+            dimension += count;
+        }
 
-        flt RandFloat() const {
-            return static_cast<flt>(RandInt()) * one_randMax;
+        // Independent stream, for example root.Split(threadID).Split(tileID), so workers and tiles
+        // never share values. Children start at dimension 0.
+        CounterRandom Split(uint32_t streamID) const {
+            return CounterRandom(Hash(streamKey, streamID ^ SplitSalt), 0, 0);
+        }
+
+        static uint32_t Get(uint32_t seed, uint32_t pixel, uint32_t sampleIndex, uint32_t bounce, uint32_t index) {
+            return Hash(Key(seed, pixel, sampleIndex, bounce), index);
+        }
+
+        // Value index of the stream with streamKey, what the batch kernels compute per lane
+        static constexpr YAM_FORCE_INLINE uint32_t Hash(uint32_t streamKey, uint32_t index) {
+            return Pcg(streamKey ^ Pcg(index));
+        }
+
+        // PCG output permutation used as a hash (Jarzynski and Olano, "Hash Functions for GPU Rendering")
+        static constexpr YAM_FORCE_INLINE uint32_t Pcg(uint32_t value) {
+            const uint32_t state = value * 747796405u + 2891336453u;
+            const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+            return (word >> 22u) ^ word;
+        }
+
+    private:
+        // Keeps split keys apart from the dimensions of the parent stream
+        static constexpr uint32_t SplitSalt = 0x5b1e7a3du;
+
+        // Nested hashing, adding every coordinate to the hash of the previous ones
+        static constexpr uint32_t Key(uint32_t seed, uint32_t pixel, uint32_t sampleIndex, uint32_t bounce) {
+            return Pcg(bounce + Pcg(sampleIndex + Pcg(pixel + Pcg(seed))));
         }
     };
 }
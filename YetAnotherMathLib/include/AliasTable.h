@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Defines.h"
+
+namespace YAM{
+    // Picks index i with probability weights[i] / sum(weights) in constant time (Walker's alias method,
+    // built with Vose's stable variant). Every bucket holds its own index up to threshold and the
+    // alias above it, so one uniform value selects a bucket and decides between the two.
+    class AliasTable {
+    private:
+        struct Bucket {
+            flt threshold;
+            uint32_t alias;
+        };
+
+        std::vector<Bucket> buckets;
+        std::vector<flt> pdfs;
+
+    public:
+        AliasTable();
+        // Negative weights count as zero. Tables with no positive weight stay empty.
+        explicit AliasTable(const std::vector<flt>& weights);
+
+        bool IsEmpty() const { return buckets.empty(); }
+        uint32_t GetSize() const { return static_cast<uint32_t>(buckets.size()); }
+
+        // u in [0, 1), outPdf is the probability of the returned index
+        uint32_t Sample(flt u, flt& outPdf) const {
+            const flt scaled = u * static_cast<flt>(buckets.size());
+            const uint32_t bucket = std::min(static_cast<uint32_t>(scaled), GetSize() - 1);
+
+            const uint32_t index = scaled - static_cast<flt>(bucket) < buckets[bucket].threshold
+                ? bucket
+                : buckets[bucket].alias;
+
+            outPdf = pdfs[index];
+            return index;
+        }
+
+        flt GetPdf(uint32_t index) const { return pdfs[index]; }
+    };
+}
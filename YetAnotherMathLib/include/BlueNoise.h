@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace YAM{
+    // Tileable blue noise ranks, one size x size mask per channel. Every channel holds each rank
+    // 0 .. size * size - 1 once, neighbouring texels get ranks far apart. Masks are made offline
+    // by yam_bluenoise (tools/BlueNoiseGenerator.cpp) and loaded at startup.
+    class BlueNoiseMask {
+    private:
+        uint32_t size;
+        uint32_t channels;
+        uint32_t sizeLog2;
+
+        std::vector<uint16_t> ranks;
+        // Ranks as 32 bit fixed point offsets in [0, 1), centered in their interval
+        std::vector<uint32_t> offsets;
+
+    public:
+        BlueNoiseMask();
+        // size has to be a power of two, at most 256 so ranks fit 16 bits
+        BlueNoiseMask(uint32_t size, uint32_t channels, std::vector<uint16_t> ranks);
+
+        static bool Load(const std::string& path, BlueNoiseMask& outMask);
+        bool Save(const std::string& path) const;
+
+        uint32_t GetSize() const { return size; }
+        uint32_t GetChannels() const { return channels; }
+        bool IsEmpty() const { return ranks.empty(); }
+
+        // Wraps around in x and y, channel is taken modulo the channel count
+        uint32_t GetOffset(uint32_t x, uint32_t y, uint32_t channel) const {
+            const uint32_t wrap = size - 1;
+            return offsets[((channel % channels) << (2 * sizeLog2)) + ((y & wrap) << sizeLog2) + (x & wrap)];
+        }
+
+        uint16_t GetRank(uint32_t x, uint32_t y, uint32_t channel) const {
+            const uint32_t wrap = size - 1;
+            return ranks[((channel % channels) << (2 * sizeLog2)) + ((y & wrap) << sizeLog2) + (x & wrap)];
+        }
+
+        static constexpr uint32_t MaxSize = 256;
+
+    private:
+        void BuildOffsets();
+    };
+}
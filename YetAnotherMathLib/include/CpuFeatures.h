@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace YAM{
+    // Instruction set levels the hot kernels are compiled for, ordered from oldest to newest
+    enum class IsaLevel : uint8_t {
+        Scalar,
+        SSE42,
+        AVX2,
+        AVX512
+    };
+
+    class CpuFeatures {
+    public:
+        // Best level supported by the CPU and the OS, from CPUID
+        static IsaLevel Detect();
+
+        // Level used by kernel dispatch, defaults to Detect() unless YAM_ISA
+        // (scalar, sse4.2, avx2, avx512) or SetLevel() asks for another one
+        static IsaLevel GetLevel();
+
+        // Override for testing, clamped to the detected level so it can never pick unsupported code
+        static void SetLevel(IsaLevel level);
+        static void ResetLevel();
+
+        static const char* ToString(IsaLevel level);
+        static bool FromString(const char* name, IsaLevel& outLevel);
+    };
+}
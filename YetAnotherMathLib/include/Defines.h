@@ -1,7 +1,25 @@
 #pragma once
 
+// Hot helpers that have to be inlined into vectorized loops
+#if defined(__GNUC__)
+#define YAM_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define YAM_FORCE_INLINE __forceinline
+#else
+#define YAM_FORCE_INLINE inline
+#endif
+
 namespace YAM {
+    // Default scalar of the math types, YAM_PRECISION=Double switches the whole build
+    // to double for reference renders. Math templates can still be used with either.
+#ifdef YAM_DOUBLE_PRECISION
+    typedef double flt;
+#else
     typedef float flt;
+#endif
+
+    template<typename T>
+    constexpr T SmallValue = static_cast<T>(1e-6);
 
-    constexpr flt SmallFloat = 1e-6;
-}
\ No newline at end of file
+    constexpr flt SmallFloat = SmallValue<flt>;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "Defines.h"
+
+namespace YAM{
+    // Polynomial float approximations of the libm transcendentals. Everything is branch free,
+    // so loops over them vectorize (see the array versions in KernelTable). Errors are measured
+    // against double precision libm over the stated ranges.
+    class FastMath {
+    public:
+        // Max abs error 9.3e-8 for |x| <= 8192 (Cody-Waite reduction into [-pi/4, pi/4]),
+        // accuracy degrades for larger arguments. Sampling angles stay within [0, 2pi].
+        static YAM_FORCE_INLINE void SinCos(float x, float& outSin, float& outCos) {
+            const int32_t quadrant = static_cast<int32_t>(x * TwoOverPi + (x < 0.f ? -0.5f : 0.5f));
+            const float q = static_cast<float>(quadrant);
+
+            // pi / 2 split in three parts, the first two have few enough bits to multiply exactly
+            const float r = ((x - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+            const float r2 = r * r;
+
+            // Minimax polynomials from Cephes sinf/cosf
+            const float sin = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+            const float cos = 1.f - 0.5f * r2
+                + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+            const bool swap = (quadrant & 1) != 0;
+            const float sinBase = swap ? cos : sin;
+            const float cosBase = swap ? sin : cos;
+
+            outSin = (quadrant & 2) != 0 ? -sinBase : sinBase;
+            outCos = ((quadrant + 1) & 2) != 0 ? -cosBase : cosBase;
+        }
+
+        static YAM_FORCE_INLINE float Sin(float x) {
+            float sin, cos;
+            SinCos(x, sin, cos);
+            return sin;
+        }
+
+        static YAM_FORCE_INLINE float Cos(float x) {
+            float sin, cos;
+            SinCos(x, sin, cos);
+            return cos;
+        }
+
+        // Max relative error 8.1e-8 (about 1 ulp) over normal floats. Returns -inf for x < FLT_MIN,
+        // so zero and denormals behave the same, and NaN for negative x.
+        static YAM_FORCE_INLINE float Log(float x) {
+            // x = 2^exponent * (m + 1) with m + 1 in [sqrt(0.5), sqrt(2)). Offsetting the bits by
+            // sqrt(0.5) picks the exponent without a data dependent branch.
+            const uint32_t bits = std::bit_cast<uint32_t>(x) + (0x3f800000u - 0x3f3504f3u);
+            const int32_t exponent = static_cast<int32_t>(bits >> 23) - 127;
+            const float m = std::bit_cast<float>((bits & 0x007fffffu) + 0x3f3504f3u) - 1.f;
+
+            const float m2 = m * m;
+            float poly = 7.0376836292e-2f;
+            poly = poly * m - 1.1514610310e-1f;
+            poly = poly * m + 1.1676998740e-1f;
+            poly = poly * m - 1.2420140846e-1f;
+            poly = poly * m + 1.4249322787e-1f;
+            poly = poly * m - 1.6668057665e-1f;
+            poly = poly * m + 2.0000714765e-1f;
+            poly = poly * m - 2.4999993993e-1f;
+            poly = poly * m + 3.3333331174e-1f;
+
+            // ln(2) split in two parts, 0.693359375 * e is exact
+            const float e = static_cast<float>(exponent);
+            const float result = m + (m * m2 * poly - 2.12194440e-4f * e - 0.5f * m2) + 0.693359375f * e;
+
+            const float outOfRange = x < 0.f ? std::numeric_limits<float>::quiet_NaN()
+                                             : -std::numeric_limits<float>::infinity();
+            return x < std::numeric_limits<float>::min() ? outOfRange : result;
+        }
+
+        // Max relative error 8.3e-8 (about 1 ulp) for x in [-87, 88]. Returns 0 below and inf above that.
+        static YAM_FORCE_INLINE float Exp(float x) {
+            // exp(x) = 2^n * exp(r) with |r| <= ln(2) / 2. Clamping n instead of x keeps the
+            // whole function free of float branches, lanes out of range get replaced at the end.
+            const int32_t rounded = static_cast<int32_t>(x * Log2E + (x < 0.f ? -0.5f : 0.5f));
+            const int32_t n = std::clamp(rounded, -126, 127);
+            const float nf = static_cast<float>(n);
+            const float r = (x - nf * 0.693359375f) + nf * 2.12194440e-4f;
+
+            float poly = 1.9875691500e-4f;
+            poly = poly * r + 1.3981999507e-3f;
+            poly = poly * r + 8.3334519073e-3f;
+            poly = poly * r + 4.1665795894e-2f;
+            poly = poly * r + 1.6666665459e-1f;
+            poly = poly * r + 5.0000001201e-1f;
+            const float expR = poly * r * r + r + 1.f;
+
+            const float result = expR * std::bit_cast<float>(static_cast<uint32_t>(n + 127) << 23);
+
+            return x < MinExp ? 0.f : (x > MaxExp ? std::numeric_limits<float>::infinity() : result);
+        }
+
+        // Exp(exponent * Log(base)), relative error stays below (|exponent * ln(base)| + 1) * 1.3e-7,
+        // 1.1e-6 for the Fresnel pow(x, 0.6) over [1e-6, 1].
+        // Defined for base >= 0 only, Pow(0, y) is 0 for y > 0.
+        static YAM_FORCE_INLINE float Pow(float base, float exponent) {
+            return Exp(exponent * Log(base));
+        }
+
+    private:
+        static constexpr float TwoOverPi = 0.636619772367581343f;
+        static constexpr float Log2E = 1.44269504088896341f;
+        static constexpr float MinExp = -87.3365447505f;
+        static constexpr float MaxExp = 88.7228391117f;
+    };
+
+    // Same interface over the standard library, the reference to compare FastMath against
+    class LibmMath {
+    public:
+        template<typename T>
+        static void SinCos(T x, T& outSin, T& outCos) {
+            outSin = std::sin(x);
+            outCos = std::cos(x);
+        }
+
+        template<typename T>
+        static T Sin(T x) { return std::sin(x); }
+
+        template<typename T>
+        static T Cos(T x) { return std::cos(x); }
+
+        template<typename T>
+        static T Log(T x) { return std::log(x); }
+
+        template<typename T>
+        static T Exp(T x) { return std::exp(x); }
+
+        template<typename T>
+        static T Pow(T base, T exponent) { return std::pow(base, exponent); }
+    };
+
+    // Scalar transcendentals of sampling and shading, picked with YAM_FAST_TRANSCENDENTALS. One at a time
+    // the table driven libm of glibc is faster than the polynomials without FMA, so libm is the default.
+    // FastMath gives the same results on every platform. Double precision builds always take libm.
+#ifdef YAM_FAST_TRANSCENDENTALS
+    using Transcendentals = std::conditional_t<std::is_same_v<flt, float>, FastMath, LibmMath>;
+#else
+    using Transcendentals = LibmMath;
+#endif
+}
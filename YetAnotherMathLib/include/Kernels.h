@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CpuFeatures.h"
+#include "LinearMath.h"
+
+namespace YAM{
+    // Hot loops compiled once per IsaLevel. All versions run the same float operations
+    // in the same order, so the result does not depend on the machine.
+    struct KernelTable {
+        IsaLevel level;
+
+        // Closest triangle hit nearer than inOutHit.distance, returns its index
+        // or std::numeric_limits<uint32_t>::max() when there is none
+        uint32_t (*intersectTriangles)(const Ray& ray, const Vector3* positions, const TriangleIndices* triangles,
+                                       uint32_t count, TriangleHit& inOutHit);
+        uint32_t (*intersectTrianglePositions)(const Ray& ray, const TrianglePositions* triangles, uint32_t count,
+                                               TriangleHit& inOutHit);
+
+        // Writes 1 for every box hit by the ray and 0 otherwise, returns the number of hits
+        uint32_t (*intersectBoxes)(const TraversalRay& ray, const AABB* boxes, uint32_t count, uint8_t* outHits);
+
+        // Value i is CounterRandom::Hash(streamKey, counter + i), lanes never depend on each other.
+        // Floats are uniform in [0, 1) from the top 24 bits.
+        void (*fillRandomInts)(uint32_t streamKey, uint32_t counter, uint32_t* out, uint32_t count);
+        void (*fillRandom)(uint32_t streamKey, uint32_t counter, flt* out, uint32_t count);
+
+        // Divides, saturates and packs linear colors the same way as Color::FromVector
+        void (*tonemap)(const Vector3* colors, uint32_t count, flt divisor, uint32_t* outPixels);
+
+        // FastMath over arrays, 8 lanes per instruction with AVX2 and 16 with AVX512.
+        // Results match the scalar FastMath functions, outputs may alias the inputs.
+        void (*sinCos)(const float* values, uint32_t count, float* outSin, float* outCos);
+        void (*log)(const float* values, uint32_t count, float* outValues);
+        void (*exp)(const float* values, uint32_t count, float* outValues);
+        void (*pow)(const float* bases, const float* exponents, uint32_t count, float* outValues);
+    };
+
+    class Kernels {
+    public:
+        // Kernels for CpuFeatures::GetLevel()
+        static const KernelTable& Get();
+
+        // Levels above CpuFeatures::Detect() fall back to the detected one
+        static const KernelTable& Get(IsaLevel level);
+    };
+}
@@ -10,8 +10,8 @@
 
 namespace YAM{
 #define M_1_180 (1. / 180.)
-    static flt ToDeg(flt rad) { return static_cast<flt>(rad * 180. * M_1_PI); }
-    static flt ToRad(flt deg) { return static_cast<flt>(deg * M_PI * M_1_180); }
+    static flt ToDeg(flt rad) { return rad * static_cast<flt>(180. * M_1_PI); }
+    static flt ToRad(flt deg) { return deg * static_cast<flt>(M_PI * M_1_180); }
     
     static flt Sign(flt x) {
         if (x > 0.f) {
@@ -40,6 +40,24 @@ namespace YAM{
         }
     };
 
+    // Ray prepared for traversal, box tests against it need no division
+    struct TraversalRay : Ray {
+        // Infinite on axes the ray is parallel to, slab distances are (bound - point) * invDirection
+        Vector3 invDirection;
+        // 1 where the direction is negative. Picks the entry bound of a box on that axis,
+        // and the near child when children are split along it.
+        uint8_t sign[3];
+
+        explicit TraversalRay(const Ray& ray)
+            : Ray(ray)
+              , invDirection(1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z)
+              , sign{invDirection.x < 0, invDirection.y < 0, invDirection.z < 0} {}
+
+        // Children split along axis in front to back order, 0 is the child on the min side
+        uint8_t NearChild(uint8_t axis) const { return sign[axis]; }
+        uint8_t FarChild(uint8_t axis) const { return sign[axis] ^ 1; }
+    };
+
     struct Sphere {
         Vector3 center;
         flt radius;
@@ -89,6 +107,27 @@ namespace YAM{
         }
     };
 
+    // Hot part of a triangle, read by every intersection test
+    struct TrianglePositions {
+        Vector3 posA;
+        Vector3 posB;
+        Vector3 posC;
+    };
+
+    // Cold part of a triangle, read once per closest hit
+    struct TriangleNormals {
+        Vector3 norA;
+        Vector3 norB;
+        Vector3 norC;
+    };
+
+    // Vertex indices of an indexed triangle
+    struct TriangleIndices {
+        uint32_t a;
+        uint32_t b;
+        uint32_t c;
+    };
+
     struct Triangle {
         Vector3 posA;
         Vector3 posB;
@@ -144,13 +183,20 @@ namespace YAM{
         flt distance;
     };
 
+    // Ray-triangle hit without shading attributes, barycentrics weight vertices B and C
+    struct TriangleHit {
+        flt distance;
+        flt barU;
+        flt barV;
+    };
+
     static Vector3 Reflect(const Vector3& in, const Vector3& normal) {
         return in - 2 * Vector3::Dot(in, normal) * normal;
     }
 
     static Vector3 Refract(const Vector3& in, const Vector3& normal, flt ratio) {
-        const flt k = 1. - ratio * ratio * (1. - Vector3::Dot(normal, in) * Vector3::Dot(normal, in));
-        if (k < 0.) {
+        const flt k = 1 - ratio * ratio * (1 - Vector3::Dot(normal, in) * Vector3::Dot(normal, in));
+        if (k < 0) {
             return Vector3{0};
         }
 
@@ -175,7 +221,7 @@ namespace YAM{
         static bool FindIntersection(const Ray& one, const Ray& another, Vector3& Result) {
             Vector3 deltaPoints = another.point - one.point;
 
-            if (std::abs(deltaPoints.Dot(one.direction.Cross(another.direction))) > 0.001) {
+            if (std::abs(deltaPoints.Dot(one.direction.Cross(another.direction))) > static_cast<flt>(0.001)) {
                 return false;
             }
 
@@ -245,15 +291,15 @@ namespace YAM{
         static bool FindIntersection(const Ray& ray, const Sphere& sphere, HitInfo& hitInfo) {
             const Vector3 centerToRayVector = ray.point - sphere.center;
             const flt a = ray.direction.Dot(ray.direction);
-            const flt b = 2. * centerToRayVector.Dot(ray.direction);
+            const flt b = 2 * centerToRayVector.Dot(ray.direction);
             const flt c = centerToRayVector.Dot(centerToRayVector) - sphere.radius * sphere.radius;
             const flt delta = b * b - 4 * a * c;
 
             if (delta < 0.f)
                 return false;
 
-            const flt solutionOne = (-b - std::sqrt(delta)) / (2. * a);
-            const flt solutionTwo = (-b + std::sqrt(delta)) / (2. * a);
+            const flt solutionOne = (-b - std::sqrt(delta)) / (2 * a);
+            const flt solutionTwo = (-b + std::sqrt(delta)) / (2 * a);
 
             const flt nearestSolution = solutionOne <= solutionTwo ? solutionOne : solutionTwo;
             if (nearestSolution <= 0)
@@ -267,12 +313,35 @@ namespace YAM{
         }
 
         static bool FindIntersection(const Ray& ray, const Triangle& tri, HitInfo& hitInfo) {
-            const Vector3 edgeAB = tri.posB - tri.posA;
-            const Vector3 edgeAC = tri.posC - tri.posA;
+            return FindIntersection(ray, tri.posA, tri.posB, tri.posC, tri.norA, tri.norB, tri.norC, hitInfo);
+        }
+
+        // Triangle given by its vertices, so indexed meshes can be traced without building Triangle
+        static bool FindIntersection(const Ray& ray,
+                                     const Vector3& posA, const Vector3& posB, const Vector3& posC,
+                                     const Vector3& norA, const Vector3& norB, const Vector3& norC,
+                                     HitInfo& hitInfo) {
+            TriangleHit triangleHit;
+            if (!FindIntersection(ray, posA, posB, posC, triangleHit)) {
+                return false;
+            }
+
+            hitInfo.hitPoint = ray.point + ray.direction * triangleHit.distance;
+            hitInfo.distance = triangleHit.distance;
+            hitInfo.normal = InterpolateNormal(norA, norB, norC, triangleHit);
+
+            return true;
+        }
+
+        // Positions only, shading attributes are interpolated later with InterpolateNormal
+        static bool FindIntersection(const Ray& ray, const Vector3& posA, const Vector3& posB, const Vector3& posC,
+                                     TriangleHit& triangleHit) {
+            const Vector3 edgeAB = posB - posA;
+            const Vector3 edgeAC = posC - posA;
 
             const Vector3 triangleNormal = Vector3::Cross(edgeAB, edgeAC);
 
-            const Vector3 aRayPoint = ray.point - tri.posA;
+            const Vector3 aRayPoint = ray.point - posA;
             const Vector3 daRayPoint = Vector3::Cross(aRayPoint, ray.direction);
 
             const flt det = -Vector3::Dot(ray.direction, triangleNormal);
@@ -292,9 +361,9 @@ namespace YAM{
             const flt barW = 1.f - barU - barV;
 
             if (barU >= 0.f && barV >= 0.f && barW >= 0.f) {
-                hitInfo.hitPoint = ray.point + ray.direction * distance;
-                hitInfo.distance = distance;
-                hitInfo.normal = (tri.norA * barW + tri.norB * barU + tri.norC * barV).Normal();
+                triangleHit.distance = distance;
+                triangleHit.barU = barU;
+                triangleHit.barV = barV;
 
                 return true;
             }
@@ -302,6 +371,12 @@ namespace YAM{
             return false;
         }
 
+        static Vector3 InterpolateNormal(const Vector3& norA, const Vector3& norB, const Vector3& norC,
+                                         const TriangleHit& triangleHit) {
+            const flt barW = 1.f - triangleHit.barU - triangleHit.barV;
+            return (norA * barW + norB * triangleHit.barU + norC * triangleHit.barV).Normal();
+        }
+
         // https://gamedev.stackexchange.com/questions/18436/most-efficient-aabb-vs-ray-collision-algorithms#18459
         static bool FindIntersection(const Ray& ray, const AABB& aabb) {
             const float t1 = (aabb.min.x - ray.point.x) / ray.direction.x;
@@ -325,7 +400,55 @@ namespace YAM{
             const float t7 = fMax > cMin ? fMax : cMin;
             const float t8 = fMin < cMax ? fMin : cMax;
 
-            return (t8 < 0 || t7 > t8) ? false : t7 > 0.f;
+            // Rays starting inside the box also count as hits
+            return t8 >= 0.f && t7 <= t8;
+        }
+
+        // Slab test without divisions. The sign bits pick the entry and exit plane per axis with
+        // selects rather than branches on the bound to load, so no min/max is needed within an axis.
+        // outEntry is the distance where the ray enters the box, negative when it starts inside.
+        static bool FindIntersection(const TraversalRay& ray, const AABB& aabb, flt& outEntry) {
+            // Subtracting first keeps the rounding error within SlabExitScale. A ray parallel to an
+            // axis gets infinite distances there, or NaN when it lies in a bounding plane.
+            const flt minX = (aabb.min.x - ray.point.x) * ray.invDirection.x;
+            const flt minY = (aabb.min.y - ray.point.y) * ray.invDirection.y;
+            const flt minZ = (aabb.min.z - ray.point.z) * ray.invDirection.z;
+            const flt maxX = (aabb.max.x - ray.point.x) * ray.invDirection.x;
+            const flt maxY = (aabb.max.y - ray.point.y) * ray.invDirection.y;
+            const flt maxZ = (aabb.max.z - ray.point.z) * ray.invDirection.z;
+
+            const flt entryX = ray.sign[0] ? maxX : minX;
+            const flt entryY = ray.sign[1] ? maxY : minY;
+            const flt entryZ = ray.sign[2] ? maxZ : minZ;
+
+            const flt exitX = ray.sign[0] ? minX : maxX;
+            const flt exitY = ray.sign[1] ? minY : maxY;
+            const flt exitZ = ray.sign[2] ? minZ : maxZ;
+
+            // Comparisons with NaN are false, so these keep the running value and skip that slab
+            flt entry = -std::numeric_limits<flt>::infinity();
+            entry = entryX > entry ? entryX : entry;
+            entry = entryY > entry ? entryY : entry;
+            entry = entryZ > entry ? entryZ : entry;
+
+            flt exit = std::numeric_limits<flt>::infinity();
+            exit = exitX < exit ? exitX : exit;
+            exit = exitY < exit ? exitY : exit;
+            exit = exitZ < exit ? exitZ : exit;
+            exit *= SlabExitScale;
+
+            outEntry = entry;
+            return exit >= 0 && entry <= exit;
+        }
+
+        static bool FindIntersection(const TraversalRay& ray, const AABB& aabb) {
+            flt entry;
+            return FindIntersection(ray, aabb, entry);
         }
+
+        // Widens the exit distance by a few ulps against rounding, so rays grazing a box still
+        // reach the geometry touching its faces (PBRT 3.9.2)
+        static constexpr flt SlabExitScale = 1 + 2 * (3 * std::numeric_limits<flt>::epsilon() / 2)
+            / (1 - 3 * std::numeric_limits<flt>::epsilon() / 2);
     };
 }
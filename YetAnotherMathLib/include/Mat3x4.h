@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "Defines.h"
+#include "Mat4.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace YAM {
+
+    // Affine transform as the top three rows of a 4x4 matrix, the last row is always 0 0 0 1.
+    // Row major, w of every row is the translation. Three quarters of a Mat4 in memory and
+    // arithmetic, points and vectors transform without the homogeneous row.
+    template<typename T>
+    class Mat3x4T {
+    public:
+        using Scalar = T;
+        using Vector3 = Vector3T<T>;
+        using Vector4 = Vector4T<T>;
+
+    private:
+        static constexpr uint8_t ROW_COUNT = 3;
+
+        std::array<Vector4, 3> rows{};
+
+    public:
+        constexpr Mat3x4T() : Mat3x4T(0) {}
+
+        // x on the diagonal of the 3x3 part, no translation
+        constexpr explicit Mat3x4T(T x) : rows{Vector4{x, 0, 0, 0}, Vector4{0, x, 0, 0}, Vector4{0, 0, x, 0}} {}
+
+        constexpr Mat3x4T(const Vector4& row0, const Vector4& row1, const Vector4& row2) : rows{row0, row1, row2} {}
+
+        // Drops the last row, which has to be 0 0 0 1 for the result to mean the same
+        constexpr explicit Mat3x4T(const Mat4T<T>& mat) {
+            for (int i = 0; i < ROW_COUNT; ++i) {
+                rows[i] = Vector4{mat[0][i], mat[1][i], mat[2][i], mat[3][i]};
+            }
+        }
+
+        constexpr Mat4T<T> ToMat4() const {
+            Mat4T<T> result(1);
+            for (int i = 0; i < 4; ++i) {
+                result[i] = Vector4{rows[0][i], rows[1][i], rows[2][i], i == 3 ? T(1) : T(0)};
+            }
+            return result;
+        }
+
+        constexpr Vector4& operator[](const uint32_t row) { return rows[row]; }
+        constexpr const Vector4& operator[](const uint32_t row) const { return rows[row]; }
+
+        constexpr Vector3 Translation() const { return {rows[0].w, rows[1].w, rows[2].w}; }
+
+        constexpr bool operator==(const Mat3x4T& another) const {
+            return rows[0] == another.rows[0] && rows[1] == another.rows[1] && rows[2] == another.rows[2];
+        }
+
+        // Applies another first and then this. Every result row is a combination of the rows
+        // of another, the implicit last row only adds this translation.
+        constexpr Mat3x4T operator*(const Mat3x4T& another) const {
+            const Vector4 unitW{0, 0, 0, 1};
+            const auto combine = [&another, &unitW](const Vector4& row) {
+                return another.rows[0] * row.x + another.rows[1] * row.y + another.rows[2] * row.z + unitW * row.w;
+            };
+
+            return {combine(rows[0]), combine(rows[1]), combine(rows[2])};
+        }
+
+        constexpr void operator*=(const Mat3x4T& another) { *this = *this * another; }
+
+        // Transposed cofactors of the 3x3 part, no translation
+        constexpr Mat3x4T Adjugate() const {
+            const Mat3x4T cofactors = Cofactors();
+            return {
+                Vector4{cofactors.rows[0].x, cofactors.rows[1].x, cofactors.rows[2].x, 0},
+                Vector4{cofactors.rows[0].y, cofactors.rows[1].y, cofactors.rows[2].y, 0},
+                Vector4{cofactors.rows[0].z, cofactors.rows[1].z, cofactors.rows[2].z, 0}
+            };
+        }
+
+        // Determinant of the 3x3 part, equal to the one of the full 4x4 matrix
+        constexpr T Det() const {
+            return DetFromCofactors(Cofactors());
+        }
+
+        // Zero matrix when the 3x3 part is singular, like Mat4::Inverse. Scalar throughout,
+        // nine cofactors do not fill registers well enough to pay for the shuffles.
+        constexpr Mat3x4T Inverse() const {
+            const Vector4& a = rows[0];
+            const Vector4& b = rows[1];
+            const Vector4& c = rows[2];
+
+            // Cofactors of the first, second and third row are the cross products b x c, c x a and a x b
+            const T c00 = b.y * c.z - b.z * c.y, c01 = b.z * c.x - b.x * c.z, c02 = b.x * c.y - b.y * c.x;
+            const T c10 = c.y * a.z - c.z * a.y, c11 = c.z * a.x - c.x * a.z, c12 = c.x * a.y - c.y * a.x;
+            const T c20 = a.y * b.z - a.z * b.y, c21 = a.z * b.x - a.x * b.z, c22 = a.x * b.y - a.y * b.x;
+
+            const T det = a.x * c00 + a.y * c01 + a.z * c02;
+            if (det == 0)
+                return Mat3x4T(0);
+
+            // Adjugate over the determinant, the translation then undoes ours
+            const T invDet = T(1) / det;
+            const T tx = a.w, ty = b.w, tz = c.w;
+
+            return {
+                Vector4{c00, c10, c20, -(c00 * tx + c10 * ty + c20 * tz)} * invDet,
+                Vector4{c01, c11, c21, -(c01 * tx + c11 * ty + c21 * tz)} * invDet,
+                Vector4{c02, c12, c22, -(c02 * tx + c12 * ty + c22 * tz)} * invDet
+            };
+        }
+
+        // Inverse transpose of the 3x3 part up to a positive scale, for normals which get renormalized
+        constexpr Mat3x4T NormalMatrix() const {
+            Mat3x4T result = Cofactors();
+            const T sign = DetFromCofactors(result) < 0 ? T(-1) : T(1);
+            for (int i = 0; i < ROW_COUNT; ++i) {
+                result.rows[i] *= sign;
+            }
+            return result;
+        }
+
+        constexpr Vector3 TransformPoint(const Vector3& point) const {
+            return {
+                rows[0].x * point.x + rows[0].y * point.y + rows[0].z * point.z + rows[0].w,
+                rows[1].x * point.x + rows[1].y * point.y + rows[1].z * point.z + rows[1].w,
+                rows[2].x * point.x + rows[2].y * point.y + rows[2].z * point.z + rows[2].w
+            };
+        }
+
+        constexpr Vector3 TransformVector(const Vector3& vector) const {
+            return {
+                rows[0].x * vector.x + rows[0].y * vector.y + rows[0].z * vector.z,
+                rows[1].x * vector.x + rows[1].y * vector.y + rows[1].z * vector.z,
+                rows[2].x * vector.x + rows[2].y * vector.y + rows[2].z * vector.z
+            };
+        }
+
+        // Builds the normal matrix every call, TransformNormals amortizes it over an array
+        Vector3 TransformNormal(const Vector3& normal) const {
+            return NormalMatrix().TransformVector(normal).Normal();
+        }
+
+        // Points and outPoints may be the same array. The columns are built once, so every point
+        // is the same column combination as in Mat4::TransformPoints minus the last row.
+        static void TransformPoints(const Mat3x4T& mat, const Vector3* points, Vector3* outPoints, size_t count) {
+            const std::array<Vector4, 4> columns = mat.Columns();
+            for (size_t i = 0; i < count; ++i) {
+                const Vector3& point = points[i];
+                const Vector4 result = columns[0] * point.x + columns[1] * point.y + columns[2] * point.z + columns[3];
+                outPoints[i] = Vector3{result.x, result.y, result.z};
+            }
+        }
+
+        // Normals come out normalized, arrays may be the same
+        static void TransformNormals(const Mat3x4T& mat, const Vector3* normals, Vector3* outNormals, size_t count) {
+            const std::array<Vector4, 4> columns = mat.NormalMatrix().Columns();
+            for (size_t i = 0; i < count; ++i) {
+                const Vector3& normal = normals[i];
+                const Vector4 result = columns[0] * normal.x + columns[1] * normal.y + columns[2] * normal.z;
+                outNormals[i] = Vector3{result.x, result.y, result.z}.Normal();
+            }
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const Mat3x4T& mat) {
+            for (int i = 0; i < ROW_COUNT; ++i) {
+                os << "[ " << mat.rows[i].x << " " << mat.rows[i].y << " " << mat.rows[i].z << " " << mat.rows[i].w
+                    << " ]" << "\n";
+            }
+            return os;
+        }
+
+    private:
+        constexpr std::array<Vector4, 4> Columns() const {
+            return {
+                Vector4{rows[0].x, rows[1].x, rows[2].x, 0}, Vector4{rows[0].y, rows[1].y, rows[2].y, 0},
+                Vector4{rows[0].z, rows[1].z, rows[2].z, 0}, Vector4{rows[0].w, rows[1].w, rows[2].w, 0}
+            };
+        }
+
+        // Cofactor of every 3x3 element, translation left at 0
+        constexpr Mat3x4T Cofactors() const {
+            Mat3x4T result;
+            for (int row = 0; row < ROW_COUNT; ++row) {
+                const Vector4& r1 = rows[(row + 1) % 3];
+                const Vector4& r2 = rows[(row + 2) % 3];
+                result.rows[row] = Vector4{
+                    r1.y * r2.z - r1.z * r2.y,
+                    r1.z * r2.x - r1.x * r2.z,
+                    r1.x * r2.y - r1.y * r2.x,
+                    0
+                };
+            }
+            return result;
+        }
+
+        constexpr T DetFromCofactors(const Mat3x4T& cofactors) const {
+            return rows[0].x * cofactors.rows[0].x + rows[0].y * cofactors.rows[0].y + rows[0].z * cofactors.rows[0].z;
+        }
+    };
+
+    using Mat3x4 = Mat3x4T<flt>;
+    using Mat3x4f = Mat3x4T<float>;
+    using Mat3x4d = Mat3x4T<double>;
+
+    static_assert(sizeof(Mat3x4f) == 3 * sizeof(Vector4f));
+    static_assert(std::is_trivially_copyable_v<Mat3x4f> && std::is_standard_layout_v<Mat3x4f>);
+    static_assert(std::is_trivially_copyable_v<Mat3x4d> && std::is_standard_layout_v<Mat3x4d>);
+}
@@ -4,13 +4,23 @@
 #include <cstdint>
 #include <ostream>
 #include <cmath>
+#include <type_traits>
 
 #include "Defines.h"
+#include "Simd.h"
+#include "Vector3.h"
 #include "Vector4.h"
 
 namespace YAM {
 
-    class Mat4 {
+    // Column major 4x4 matrix over the scalar T
+    template<typename T>
+    class Mat4T {
+    public:
+        using Scalar = T;
+        using Vector3 = Vector3T<T>;
+        using Vector4 = Vector4T<T>;
+
     private:
         static constexpr uint8_t GRID_SIZE_X = 4;
         static constexpr uint8_t GRID_SIZE_Y = 4;
@@ -18,9 +28,9 @@ namespace YAM {
         std::array<Vector4, 4> grid{};
 
     public:
-        Mat4() : Mat4(0) {}
+        constexpr Mat4T() : Mat4T(0) {}
 
-        explicit Mat4(flt x) {
+        constexpr explicit Mat4T(T x) {
             for (int i = 0; i < GRID_SIZE_X; ++i) {
                 for (int j = 0; j < GRID_SIZE_Y; ++j) {
                     if (i == j)
@@ -31,73 +41,51 @@ namespace YAM {
             }
         }
 
-        Mat4(const Mat4& clone) {
-            for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    grid[i][j] = clone.grid[i][j];
-                }
-            }
-        }
-
-        flt operator[](const std::pair<int, int>& coordinates) const {
+        constexpr T operator[](const std::pair<int, int>& coordinates) const {
             return grid[coordinates.first][coordinates.second];
         }
         
-        flt& operator[](const std::pair<int, int>& coordinates) {
+        constexpr T& operator[](const std::pair<int, int>& coordinates) {
             return grid[coordinates.first][coordinates.second];
         }
         
-        Vector4& operator[](const uint32_t index) {
+        constexpr Vector4& operator[](const uint32_t index) {
             return grid[index];
         }
         
-        const Vector4& operator[](const uint32_t index) const {
+        constexpr const Vector4& operator[](const uint32_t index) const {
             return grid[index];
         }
 
-        Mat4 operator-() const {
-            Mat4 result(0);
-            for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    result.grid[i][j] = -this->grid[i][j];
-                }
-            }
-            return result;
-        }
+        // Column wise operations, Vector4 maps every column onto one SIMD register
 
-        Mat4 operator+(const Mat4& another) const {
-            Mat4 result(0);
+        constexpr Mat4T operator-() const {
+            Mat4T result(0);
             for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    result.grid[i][j] = grid[i][j] + another.grid[i][j];
-                }
+                result.grid[i] = -grid[i];
             }
-
             return result;
         }
 
-        Mat4 operator-(const Mat4& another) const {
-            Mat4 result(0);
+        constexpr Mat4T operator+(const Mat4T& another) const {
+            Mat4T result(0);
             for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    result.grid[i][j] = grid[i][j] - another.grid[i][j];
-                }
+                result.grid[i] = grid[i] + another.grid[i];
             }
 
             return result;
         }
 
-        Mat4& operator=(const Mat4& another) {
+        constexpr Mat4T operator-(const Mat4T& another) const {
+            Mat4T result(0);
             for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    grid[i][j] = another.grid[i][j];
-                }
+                result.grid[i] = grid[i] - another.grid[i];
             }
 
-            return *this;
+            return result;
         }
 
-        bool operator==(const Mat4& another) const {
+        constexpr bool operator==(const Mat4T& another) const {
             for (int i = 0; i < GRID_SIZE_X; ++i) {
                 for (int j = 0; j < GRID_SIZE_Y; ++j) {
                     if(grid[i][j] != another.grid[i][j])
@@ -108,48 +96,55 @@ namespace YAM {
             return true;
         }
 
-        void operator+=(const Mat4& another) {
+        constexpr void operator+=(const Mat4T& another) {
             *this = *this + another;
         }
 
-        void operator-=(const Mat4& another) {
+        constexpr void operator-=(const Mat4T& another) {
             *this = *this - another;
         }
 
-        Mat4 operator*(const flt scalar) const {
-            Mat4 result(0);
+        constexpr Mat4T operator*(const T scalar) const {
+            Mat4T result(0);
             for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    result.grid[i][j] = scalar * grid[i][j];
-                }
+                result.grid[i] = grid[i] * scalar;
             }
             return result;
         }
 
-        void operator*=(flt scalar) {
+        constexpr void operator*=(T scalar) {
             *this = *this * scalar;
         }
 
-        Mat4 operator*(const Mat4& another) const {
-            Mat4 result(0);
+        // Every result column is a combination of this matrix columns
+        constexpr Mat4T operator*(const Mat4T& another) const {
+            Mat4T result(0);
             for (int i = 0; i < GRID_SIZE_X; ++i) {
-                for (int j = 0; j < GRID_SIZE_Y; ++j) {
-                    for (int k = 0; k < GRID_SIZE_X; ++k) {
-                        result.grid[i][j] += grid[k][j] * another.grid[i][k];
-                    }
-                }
+                result.grid[i] = *this * another.grid[i];
             }
 
             return result;
         }
 
-        void operator*=(const Mat4& Another) {
+        constexpr void operator*=(const Mat4T& Another) {
             *this = *this * Another;
         }
 
-        Mat4 Transpose() const {
-            Mat4 result(0);
+        constexpr Mat4T Transpose() const {
+            Mat4T result(*this);
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated()) {
+                    Simd::Float4 columns[4] = {grid[0].Load(), grid[1].Load(), grid[2].Load(), grid[3].Load()};
+                    Simd::Transpose(columns[0], columns[1], columns[2], columns[3]);
 
+                    for (int i = 0; i < GRID_SIZE_X; i++) {
+                        result.grid[i] = Vector4::Store(columns[i]);
+                    }
+                    return result;
+                }
+            }
+#endif
             for (int i = 0; i < GRID_SIZE_X; i++) {
                 for (int j = 0; j < GRID_SIZE_Y; j++) {
                     result.grid[i][j] = grid[j][i];
@@ -158,161 +153,72 @@ namespace YAM {
             return result;
         }
 
-        flt Det() const {
-            flt result = 1;
-            Mat4 helper(*this);
-            for (int i = 0; i < 4; i++) {
-                for (int k = i + 1; k < 4; k++) {
-                    const flt coefficient = helper.grid[k][i] / helper.grid[i][i];
-                    for (int j = i; j < 4; j++)
-                        helper.grid[k][j] = helper.grid[k][j] - coefficient * helper.grid[i][j];
-                }
-            }
-            for (int i = 0; i < 4; i++)
-                result *= helper.grid[i][i];
+        // Transposed cofactor matrix, equal to Inverse() * Det()
+        constexpr Mat4T Adjugate() const {
+            const std::array<Vector4, 4>& m = grid;
+
+            // 2x2 minors of the last two columns, rows picked so that whole columns of the result
+            // come out of single vector operations
+            const auto minors = [&m](int p, int q) {
+                return Vector4{m[2][p], m[2][p], m[1][p], m[1][p]}.Mul(Vector4{m[3][q], m[3][q], m[3][q], m[2][q]})
+                    - Vector4{m[3][p], m[3][p], m[3][p], m[2][p]}.Mul(Vector4{m[2][q], m[2][q], m[1][q], m[1][q]});
+            };
+
+            const Vector4 minors23 = minors(2, 3);
+            const Vector4 minors13 = minors(1, 3);
+            const Vector4 minors12 = minors(1, 2);
+            const Vector4 minors03 = minors(0, 3);
+            const Vector4 minors02 = minors(0, 2);
+            const Vector4 minors01 = minors(0, 1);
+
+            const Vector4 pivots0{m[1][0], m[0][0], m[0][0], m[0][0]};
+            const Vector4 pivots1{m[1][1], m[0][1], m[0][1], m[0][1]};
+            const Vector4 pivots2{m[1][2], m[0][2], m[0][2], m[0][2]};
+            const Vector4 pivots3{m[1][3], m[0][3], m[0][3], m[0][3]};
+
+            const Vector4 signA{1, -1, 1, -1};
+            const Vector4 signB{-1, 1, -1, 1};
+
+            Mat4T result(0);
+            result.grid[0] = (pivots1.Mul(minors23) - pivots2.Mul(minors13) + pivots3.Mul(minors12)).Mul(signA);
+            result.grid[1] = (pivots0.Mul(minors23) - pivots2.Mul(minors03) + pivots3.Mul(minors02)).Mul(signB);
+            result.grid[2] = (pivots0.Mul(minors13) - pivots1.Mul(minors03) + pivots3.Mul(minors01)).Mul(signA);
+            result.grid[3] = (pivots0.Mul(minors12) - pivots1.Mul(minors02) + pivots2.Mul(minors01)).Mul(signB);
+
             return result;
         }
 
-        Mat4 Inverse() const {
-            std::array<flt, 16> result{};
-            std::array<flt, 16> flatGrid{};
-
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; ++j) {
-                    flatGrid[i + j * 4] = grid[j][i];
-                }
-            }
+        // Laplace expansion along the first column, reusing the adjugate
+        constexpr T Det() const {
+            return DetFromAdjugate(Adjugate());
+        }
 
-            result[0] = flatGrid[5] * flatGrid[10] * flatGrid[15] -
-                        flatGrid[5] * flatGrid[11] * flatGrid[14] -
-                        flatGrid[9] * flatGrid[6] * flatGrid[15] +
-                        flatGrid[9] * flatGrid[7] * flatGrid[14] +
-                        flatGrid[13] * flatGrid[6] * flatGrid[11] -
-                        flatGrid[13] * flatGrid[7] * flatGrid[10];
-
-            result[4] = -flatGrid[4] * flatGrid[10] * flatGrid[15] +
-                        flatGrid[4] * flatGrid[11] * flatGrid[14] +
-                        flatGrid[8] * flatGrid[6] * flatGrid[15] -
-                        flatGrid[8] * flatGrid[7] * flatGrid[14] -
-                        flatGrid[12] * flatGrid[6] * flatGrid[11] +
-                        flatGrid[12] * flatGrid[7] * flatGrid[10];
-
-            result[8] = flatGrid[4] * flatGrid[9] * flatGrid[15] -
-                        flatGrid[4] * flatGrid[11] * flatGrid[13] -
-                        flatGrid[8] * flatGrid[5] * flatGrid[15] +
-                        flatGrid[8] * flatGrid[7] * flatGrid[13] +
-                        flatGrid[12] * flatGrid[5] * flatGrid[11] -
-                        flatGrid[12] * flatGrid[7] * flatGrid[9];
-
-            result[12] = -flatGrid[4] * flatGrid[9] * flatGrid[14] +
-                         flatGrid[4] * flatGrid[10] * flatGrid[13] +
-                         flatGrid[8] * flatGrid[5] * flatGrid[14] -
-                         flatGrid[8] * flatGrid[6] * flatGrid[13] -
-                         flatGrid[12] * flatGrid[5] * flatGrid[10] +
-                         flatGrid[12] * flatGrid[6] * flatGrid[9];
-
-            result[1] = -flatGrid[1] * flatGrid[10] * flatGrid[15] +
-                        flatGrid[1] * flatGrid[11] * flatGrid[14] +
-                        flatGrid[9] * flatGrid[2] * flatGrid[15] -
-                        flatGrid[9] * flatGrid[3] * flatGrid[14] -
-                        flatGrid[13] * flatGrid[2] * flatGrid[11] +
-                        flatGrid[13] * flatGrid[3] * flatGrid[10];
-
-            result[5] = flatGrid[0] * flatGrid[10] * flatGrid[15] -
-                        flatGrid[0] * flatGrid[11] * flatGrid[14] -
-                        flatGrid[8] * flatGrid[2] * flatGrid[15] +
-                        flatGrid[8] * flatGrid[3] * flatGrid[14] +
-                        flatGrid[12] * flatGrid[2] * flatGrid[11] -
-                        flatGrid[12] * flatGrid[3] * flatGrid[10];
-
-            result[9] = -flatGrid[0] * flatGrid[9] * flatGrid[15] +
-                        flatGrid[0] * flatGrid[11] * flatGrid[13] +
-                        flatGrid[8] * flatGrid[1] * flatGrid[15] -
-                        flatGrid[8] * flatGrid[3] * flatGrid[13] -
-                        flatGrid[12] * flatGrid[1] * flatGrid[11] +
-                        flatGrid[12] * flatGrid[3] * flatGrid[9];
-
-            result[13] = flatGrid[0] * flatGrid[9] * flatGrid[14] -
-                         flatGrid[0] * flatGrid[10] * flatGrid[13] -
-                         flatGrid[8] * flatGrid[1] * flatGrid[14] +
-                         flatGrid[8] * flatGrid[2] * flatGrid[13] +
-                         flatGrid[12] * flatGrid[1] * flatGrid[10] -
-                         flatGrid[12] * flatGrid[2] * flatGrid[9];
-
-            result[2] = flatGrid[1] * flatGrid[6] * flatGrid[15] -
-                        flatGrid[1] * flatGrid[7] * flatGrid[14] -
-                        flatGrid[5] * flatGrid[2] * flatGrid[15] +
-                        flatGrid[5] * flatGrid[3] * flatGrid[14] +
-                        flatGrid[13] * flatGrid[2] * flatGrid[7] -
-                        flatGrid[13] * flatGrid[3] * flatGrid[6];
-
-            result[6] = -flatGrid[0] * flatGrid[6] * flatGrid[15] +
-                        flatGrid[0] * flatGrid[7] * flatGrid[14] +
-                        flatGrid[4] * flatGrid[2] * flatGrid[15] -
-                        flatGrid[4] * flatGrid[3] * flatGrid[14] -
-                        flatGrid[12] * flatGrid[2] * flatGrid[7] +
-                        flatGrid[12] * flatGrid[3] * flatGrid[6];
-
-            result[10] = flatGrid[0] * flatGrid[5] * flatGrid[15] -
-                         flatGrid[0] * flatGrid[7] * flatGrid[13] -
-                         flatGrid[4] * flatGrid[1] * flatGrid[15] +
-                         flatGrid[4] * flatGrid[3] * flatGrid[13] +
-                         flatGrid[12] * flatGrid[1] * flatGrid[7] -
-                         flatGrid[12] * flatGrid[3] * flatGrid[5];
-
-            result[14] = -flatGrid[0] * flatGrid[5] * flatGrid[14] +
-                         flatGrid[0] * flatGrid[6] * flatGrid[13] +
-                         flatGrid[4] * flatGrid[1] * flatGrid[14] -
-                         flatGrid[4] * flatGrid[2] * flatGrid[13] -
-                         flatGrid[12] * flatGrid[1] * flatGrid[6] +
-                         flatGrid[12] * flatGrid[2] * flatGrid[5];
-
-            result[3] = -flatGrid[1] * flatGrid[6] * flatGrid[11] +
-                        flatGrid[1] * flatGrid[7] * flatGrid[10] +
-                        flatGrid[5] * flatGrid[2] * flatGrid[11] -
-                        flatGrid[5] * flatGrid[3] * flatGrid[10] -
-                        flatGrid[9] * flatGrid[2] * flatGrid[7] +
-                        flatGrid[9] * flatGrid[3] * flatGrid[6];
-
-            result[7] = flatGrid[0] * flatGrid[6] * flatGrid[11] -
-                        flatGrid[0] * flatGrid[7] * flatGrid[10] -
-                        flatGrid[4] * flatGrid[2] * flatGrid[11] +
-                        flatGrid[4] * flatGrid[3] * flatGrid[10] +
-                        flatGrid[8] * flatGrid[2] * flatGrid[7] -
-                        flatGrid[8] * flatGrid[3] * flatGrid[6];
-
-            result[11] = -flatGrid[0] * flatGrid[5] * flatGrid[11] +
-                         flatGrid[0] * flatGrid[7] * flatGrid[9] +
-                         flatGrid[4] * flatGrid[1] * flatGrid[11] -
-                         flatGrid[4] * flatGrid[3] * flatGrid[9] -
-                         flatGrid[8] * flatGrid[1] * flatGrid[7] +
-                         flatGrid[8] * flatGrid[3] * flatGrid[5];
-
-            result[15] = flatGrid[0] * flatGrid[5] * flatGrid[10] -
-                         flatGrid[0] * flatGrid[6] * flatGrid[9] -
-                         flatGrid[4] * flatGrid[1] * flatGrid[10] +
-                         flatGrid[4] * flatGrid[2] * flatGrid[9] +
-                         flatGrid[8] * flatGrid[1] * flatGrid[6] -
-                         flatGrid[8] * flatGrid[2] * flatGrid[5];
-
-
-            const float det = this->Det();
+        constexpr Mat4T Inverse() const {
+            const Mat4T adjugate = Adjugate();
+            const T det = DetFromAdjugate(adjugate);
 
             if (det == 0)
-                return Mat4(0);
+                return Mat4T(0);
 
-            Mat4 finalResult(0);
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; ++j) {
-                    finalResult.grid[i][j] = result[i * 4 + j] / det;
-                }
-            }
+            return adjugate * (T(1) / det);
+        }
 
-            return finalResult;
+        // Inverse transpose of the upper 3x3 up to a positive scale, for normals which get renormalized
+        constexpr Mat4T NormalMatrix() const {
+            const Mat4T adjugate = Adjugate();
+            const T sign = DetFromAdjugate(adjugate) < 0 ? T(-1) : T(1);
+
+            Mat4T result = adjugate.Transpose() * sign;
+            result.grid[0].w = 0;
+            result.grid[1].w = 0;
+            result.grid[2].w = 0;
+            result.grid[3] = Vector4{0, 0, 0, 1};
+
+            return result;
         }
 
-        Mat4 ClearTranslation() const {
-            Mat4 result = *this;
+        constexpr Mat4T ClearTranslation() const {
+            Mat4T result = *this;
             
             result.grid[3][0] = 0;
             result.grid[3][1] = 0;
@@ -321,7 +227,7 @@ namespace YAM {
             return result;
         }
 
-        friend std::ostream &operator<<(std::ostream &os, const Mat4 &mat4) {
+        friend std::ostream &operator<<(std::ostream &os, const Mat4T &mat4) {
             for (int i = 0; i < 4; ++i) {
                 os << "[ ";
                 for (int j = 0; j < 4; ++j) {
@@ -332,8 +238,8 @@ namespace YAM {
             return os;
         }
 
-        static Mat4 Translation(flt x, flt y, flt z) {
-            Mat4 result(1);
+        static constexpr Mat4T Translation(T x, T y, T z) {
+            Mat4T result(1);
 
             result[{3, 0}] = x;
             result[{3, 1}] = y;
@@ -342,9 +248,9 @@ namespace YAM {
         }
 
 
-        static Mat4 Scale(flt x, flt y, flt z)
+        static constexpr Mat4T Scale(T x, T y, T z)
         {
-            Mat4 result(1);
+            Mat4T result(1);
 
             result[{0, 0}] = x;
             result[{1, 1}] = y;
@@ -352,9 +258,9 @@ namespace YAM {
             return  result;
         }
 
-        static Mat4 RotationX(flt radians)
+        static Mat4T RotationX(T radians)
         {
-            Mat4 result(1);
+            Mat4T result(1);
 
             result[{1, 1}] = std::cos(radians);
             result[{2, 1}] = -std::sin(radians);
@@ -363,9 +269,9 @@ namespace YAM {
             return  result;
         }
 
-        static Mat4 RotationY(flt radians)
+        static Mat4T RotationY(T radians)
         {
-            Mat4 result(1);
+            Mat4T result(1);
 
             result[{0, 0}] = std::cos(radians);
             result[{0, 2}] = std::sin(radians);
@@ -374,9 +280,9 @@ namespace YAM {
             return  result;
         }
 
-        static Mat4 RotationZ(flt radians)
+        static Mat4T RotationZ(T radians)
         {
-            Mat4 result(1);
+            Mat4T result(1);
 
             result[{0, 0}] = std::cos(radians);
             result[{0, 1}] = -std::sin(radians);
@@ -385,21 +291,21 @@ namespace YAM {
             return  result;
         }
 
-        static Mat4 Perspective(flt fov, flt aspect, flt near, flt far) {
-            Mat4 result {0};
+        static Mat4T Perspective(T fov, T aspect, T near, T far) {
+            Mat4T result {0};
             
-            flt f = std::cos(fov) / std::sin(fov);
+            T f = std::cos(fov) / std::sin(fov);
             result[{0, 0}] = f / aspect;
             result[{1, 1}] = f;
             result[{2, 2}] = (far + near) / (near - far);
-            result[{3, 2}] = -1.;
-            result[{3, 2}] = 2. * far * near / (near - far);
+            result[{3, 2}] = -1;
+            result[{3, 2}] = 2 * far * near / (near - far);
 
             return result;
         }
 
-        static Mat4 LookAt(const Vector3& eye, const Vector3& center, const Vector3& up) {
-            Mat4 result {0};
+        static Mat4T LookAt(const Vector3& eye, const Vector3& center, const Vector3& up) {
+            Mat4T result {0};
             
             const Vector3 forward = (center - eye).Normal();
             const Vector3 left = Vector3::Cross(forward, up);
@@ -413,14 +319,41 @@ namespace YAM {
             return result;
         }
         
-        Vector4 operator*(const Vector4& vec4) const {
-            Vector4 result;
-            result.x = vec4.x * grid[0][0] + vec4.y * grid[1][0] + vec4.z * grid[2][0] + vec4.w * grid[3][0];
-            result.y = vec4.x * grid[0][1] + vec4.y * grid[1][1] + vec4.z * grid[2][1] + vec4.w * grid[3][1];
-            result.z = vec4.x * grid[0][2] + vec4.y * grid[1][2] + vec4.z * grid[2][2] + vec4.w * grid[3][2];
-            result.w = vec4.x * grid[0][3] + vec4.y * grid[1][3] + vec4.z * grid[2][3] + vec4.w * grid[3][3];
+        constexpr Vector4 operator*(const Vector4& vec4) const {
+            return grid[0] * vec4.x + grid[1] * vec4.y + grid[2] * vec4.z + grid[3] * vec4.w;
+        }
 
-            return result;
+        // Same as multiplying every point with w = 1, points and outPoints may be the same array
+        static void TransformPoints(const Mat4T& mat, const Vector3* points, Vector3* outPoints, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const Vector3& point = points[i];
+                const Vector4 result = mat.grid[0] * point.x + mat.grid[1] * point.y + mat.grid[2] * point.z + mat.grid[3];
+                outPoints[i] = Vector3{result.x, result.y, result.z};
+            }
+        }
+
+        // Normals go through NormalMatrix() and come out normalized, arrays may be the same
+        static void TransformNormals(const Mat4T& mat, const Vector3* normals, Vector3* outNormals, size_t count) {
+            const Mat4T normalMatrix = mat.NormalMatrix();
+            for (size_t i = 0; i < count; ++i) {
+                const Vector3& normal = normals[i];
+                const Vector4 result = normalMatrix.grid[0] * normal.x + normalMatrix.grid[1] * normal.y
+                    + normalMatrix.grid[2] * normal.z;
+                outNormals[i] = Vector3{result.x, result.y, result.z}.Normal();
+            }
+        }
+
+    private:
+        constexpr T DetFromAdjugate(const Mat4T& adjugate) const {
+            return grid[0].x * adjugate.grid[0].x + grid[0].y * adjugate.grid[1].x
+                + grid[0].z * adjugate.grid[2].x + grid[0].w * adjugate.grid[3].x;
         }
     };
+
+    using Mat4 = Mat4T<flt>;
+    using Mat4f = Mat4T<float>;
+    using Mat4d = Mat4T<double>;
+
+    static_assert(std::is_trivially_copyable_v<Mat4f> && std::is_standard_layout_v<Mat4f>);
+    static_assert(std::is_trivially_copyable_v<Mat4d> && std::is_standard_layout_v<Mat4d>);
 }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Defines.h"
+#include "LinearMath.h"
+#include "Vector3.h"
+
+namespace YAM{
+    struct QuantizedPosition {
+        uint16_t x;
+        uint16_t y;
+        uint16_t z;
+    };
+
+    class Quantization {
+    public:
+        static constexpr flt Unorm16Max = 65535.f;
+        static constexpr flt Snorm16Max = 32767.f;
+
+        // Maximum error per axis is half of a step, (bounds.max - bounds.min) / 131070
+        static QuantizedPosition QuantizePosition(const Vector3& position, const AABB& bounds) {
+            const Vector3 extent = bounds.max - bounds.min;
+
+            return {
+                QuantizeUnorm16(position.x - bounds.min.x, extent.x),
+                QuantizeUnorm16(position.y - bounds.min.y, extent.y),
+                QuantizeUnorm16(position.z - bounds.min.z, extent.z)
+            };
+        }
+
+        // dequantizeScale is (bounds.max - bounds.min) / Unorm16Max
+        static Vector3 DequantizePosition(const QuantizedPosition& position, const Vector3& boundsMin,
+                                          const Vector3& dequantizeScale) {
+            return {
+                boundsMin.x + static_cast<flt>(position.x) * dequantizeScale.x,
+                boundsMin.y + static_cast<flt>(position.y) * dequantizeScale.y,
+                boundsMin.z + static_cast<flt>(position.z) * dequantizeScale.z
+            };
+        }
+
+        static Vector3 DequantizeScale(const AABB& bounds) {
+            return (bounds.max - bounds.min) / Unorm16Max;
+        }
+
+        // Octahedral normal encoding, two 16 bit snorms packed in 32 bits.
+        // Angular error stays below 0.005 degree.
+        static uint32_t EncodeNormal(const Vector3& normal) {
+            const flt manhattanLength = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            if (manhattanLength < SmallFloat) {
+                return PackSnorm16(0.f, 0.f);
+            }
+
+            flt u = normal.x / manhattanLength;
+            flt v = normal.y / manhattanLength;
+
+            // Fold lower hemisphere over the diagonals
+            if (normal.z < 0.f) {
+                const flt foldedU = (1.f - std::abs(v)) * SignNotZero(u);
+                const flt foldedV = (1.f - std::abs(u)) * SignNotZero(v);
+                u = foldedU;
+                v = foldedV;
+            }
+
+            return PackSnorm16(u, v);
+        }
+
+        static Vector3 DecodeNormal(uint32_t encoded) {
+            const flt u = UnpackSnorm16(static_cast<uint16_t>(encoded & 0xFFFF));
+            const flt v = UnpackSnorm16(static_cast<uint16_t>(encoded >> 16));
+
+            Vector3 result{u, v, 1.f - std::abs(u) - std::abs(v)};
+
+            const flt unfold = std::max(-result.z, static_cast<flt>(0.f));
+            result.x += result.x >= 0.f ? -unfold : unfold;
+            result.y += result.y >= 0.f ? -unfold : unfold;
+
+            return result.Normal();
+        }
+
+    private:
+        static uint16_t QuantizeUnorm16(flt offset, flt extent) {
+            if (extent <= 0.f) {
+                return 0;
+            }
+
+            const flt normalized = std::clamp(offset / extent, static_cast<flt>(0.f), static_cast<flt>(1.f));
+            return static_cast<uint16_t>(std::lround(normalized * Unorm16Max));
+        }
+
+        static flt SignNotZero(flt x) {
+            return x >= 0.f ? 1.f : -1.f;
+        }
+
+        static uint32_t PackSnorm16(flt u, flt v) {
+            const auto pack = [](flt value) {
+                const flt clamped = std::clamp(value, static_cast<flt>(-1.f), static_cast<flt>(1.f));
+                return static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(std::lround(clamped * Snorm16Max))));
+            };
+
+            return pack(u) | (pack(v) << 16);
+        }
+
+        static flt UnpackSnorm16(uint16_t value) {
+            return std::max(static_cast<flt>(static_cast<int16_t>(value)) / Snorm16Max, static_cast<flt>(-1.f));
+        }
+    };
+}
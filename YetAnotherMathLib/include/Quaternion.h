@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+#include "Defines.h"
+#include "Mat4.h"
+#include "Simd.h"
+#include "Vector3.h"
+
+namespace YAM{
+    // x, y, z is the vector part and w the scalar part. Rotations are unit quaternions,
+    // they rotate counterclockwise around their axis when looking against it (right handed).
+    template<typename T>
+    class YAM_VECTOR_ALIGN QuaternionT {
+    public:
+        using Scalar = T;
+        using Vector3 = Vector3T<T>;
+
+        T x;
+        T y;
+        T z;
+        T w;
+
+        // Identity rotation
+        constexpr QuaternionT() : x(0), y(0), z(0), w(1) {}
+        constexpr QuaternionT(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+        constexpr QuaternionT(const Vector3& vector, T scalar) : x(vector.x), y(vector.y), z(vector.z), w(scalar) {}
+
+        static QuaternionT FromAxisAngle(const Vector3& axis, T radians) {
+            const T halfAngle = radians / 2;
+            const Vector3 unitAxis = axis.Normal();
+            return QuaternionT{unitAxis * std::sin(halfAngle), std::cos(halfAngle)};
+        }
+
+        // Rotation part of a matrix whose upper 3x3 is orthonormal (Shepperd's method,
+        // divides by the largest diagonal term so it stays accurate near 180 degrees)
+        static QuaternionT FromMat4(const Mat4T<T>& mat) {
+            // mat[column][row]
+            const T m00 = mat[0][0], m01 = mat[1][0], m02 = mat[2][0];
+            const T m10 = mat[0][1], m11 = mat[1][1], m12 = mat[2][1];
+            const T m20 = mat[0][2], m21 = mat[1][2], m22 = mat[2][2];
+
+            const T trace = m00 + m11 + m22;
+            if (trace > 0) {
+                const T s = std::sqrt(trace + 1) * 2;
+                return QuaternionT{(m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, s / 4}.Normal();
+            }
+            if (m00 > m11 && m00 > m22) {
+                const T s = std::sqrt(1 + m00 - m11 - m22) * 2;
+                return QuaternionT{s / 4, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s}.Normal();
+            }
+            if (m11 > m22) {
+                const T s = std::sqrt(1 + m11 - m00 - m22) * 2;
+                return QuaternionT{(m01 + m10) / s, s / 4, (m12 + m21) / s, (m02 - m20) / s}.Normal();
+            }
+
+            const T s = std::sqrt(1 + m22 - m00 - m11) * 2;
+            return QuaternionT{(m02 + m20) / s, (m12 + m21) / s, s / 4, (m10 - m01) / s}.Normal();
+        }
+
+        // Rotation matrix of a unit quaternion
+        constexpr Mat4T<T> ToMat4() const {
+            const T xx = x * x, yy = y * y, zz = z * z;
+            const T xy = x * y, xz = x * z, yz = y * z;
+            const T wx = w * x, wy = w * y, wz = w * z;
+
+            Mat4T<T> result(1);
+            result[0] = Vector4T<T>{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0};
+            result[1] = Vector4T<T>{2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0};
+            result[2] = Vector4T<T>{2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0};
+            return result;
+        }
+
+        constexpr Vector3 VectorPart() const { return {x, y, z}; }
+
+        constexpr T Dot(const QuaternionT& rhs) const { return x * rhs.x + y * rhs.y + z * rhs.z + w * rhs.w; }
+        constexpr T SquaredLength() const { return Dot(*this); }
+        T Length() const { return std::sqrt(SquaredLength()); }
+
+        QuaternionT Normal() const {
+            const T length = Length();
+            if (length < SmallValue<T>)
+                return QuaternionT{};
+
+            return *this * (1 / length);
+        }
+
+        constexpr QuaternionT Conjugate() const { return {-x, -y, -z, w}; }
+
+        // Conjugate divided by the squared length, equal to Conjugate() for rotations
+        constexpr QuaternionT Inverse() const {
+            const T squaredLength = SquaredLength();
+            if (squaredLength == 0)
+                return QuaternionT{0, 0, 0, 0};
+
+            return Conjugate() * (1 / squaredLength);
+        }
+
+        // v + 2w (u x v) + 2 u x (u x v) with u the vector part, cheaper than q * v * q^-1.
+        // Written out per component, the shuffles of two SIMD cross products cost more here.
+        constexpr Vector3 Rotate(const Vector3& vector) const {
+            const T tx = 2 * (y * vector.z - z * vector.y);
+            const T ty = 2 * (z * vector.x - x * vector.z);
+            const T tz = 2 * (x * vector.y - y * vector.x);
+
+            return {
+                vector.x + w * tx + (y * tz - z * ty),
+                vector.y + w * ty + (z * tx - x * tz),
+                vector.z + w * tz + (x * ty - y * tx)
+            };
+        }
+
+        // Hamilton product, the result applies another first and then this
+        constexpr QuaternionT operator*(const QuaternionT& another) const {
+            return {
+                w * another.x + x * another.w + y * another.z - z * another.y,
+                w * another.y - x * another.z + y * another.w + z * another.x,
+                w * another.z + x * another.y - y * another.x + z * another.w,
+                w * another.w - x * another.x - y * another.y - z * another.z
+            };
+        }
+
+        constexpr void operator*=(const QuaternionT& another) { *this = *this * another; }
+
+        constexpr QuaternionT operator*(T scalar) const { return {x * scalar, y * scalar, z * scalar, w * scalar}; }
+        constexpr QuaternionT operator+(const QuaternionT& another) const {
+            return {x + another.x, y + another.y, z + another.z, w + another.w};
+        }
+        constexpr QuaternionT operator-(const QuaternionT& another) const {
+            return {x - another.x, y - another.y, z - another.z, w - another.w};
+        }
+        constexpr QuaternionT operator-() const { return {-x, -y, -z, -w}; }
+
+        constexpr bool operator==(const QuaternionT& rhs) const {
+            return x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w;
+        }
+        constexpr bool operator!=(const QuaternionT& rhs) const { return !(*this == rhs); }
+
+        // Normalized linear interpolation along the shorter arc, not constant speed but
+        // close to Slerp for the small steps between animation keys
+        static QuaternionT Nlerp(const QuaternionT& a, const QuaternionT& b, T t) {
+            const QuaternionT end = a.Dot(b) < 0 ? -b : b;
+            return (a + (end - a) * t).Normal();
+        }
+
+        // Constant speed interpolation along the shorter arc
+        static QuaternionT Slerp(const QuaternionT& a, const QuaternionT& b, T t) {
+            T cosAngle = a.Dot(b);
+            const QuaternionT end = cosAngle < 0 ? -b : b;
+            cosAngle = std::abs(cosAngle);
+
+            // sin(angle) gets too small to divide by for nearly equal rotations
+            if (cosAngle > T(0.9995))
+                return Nlerp(a, end, t);
+
+            const T angle = std::acos(cosAngle);
+            const T invSin = 1 / std::sin(angle);
+            return a * (std::sin((1 - t) * angle) * invSin) + end * (std::sin(t * angle) * invSin);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const QuaternionT& quaternion) {
+            os << "(" << quaternion.w << " + [" << quaternion.x << "," << quaternion.y << "," << quaternion.z << "])";
+            return os;
+        }
+    };
+
+    using Quaternion = QuaternionT<flt>;
+    using Quaternionf = QuaternionT<float>;
+    using Quaterniond = QuaternionT<double>;
+
+    static_assert(std::is_trivially_copyable_v<Quaternionf> && std::is_standard_layout_v<Quaternionf>);
+    static_assert(std::is_trivially_copyable_v<Quaterniond> && std::is_standard_layout_v<Quaterniond>);
+}
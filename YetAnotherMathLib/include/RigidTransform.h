@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+#include "Defines.h"
+#include "Mat4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace YAM{
+    // Rotation, uniform scale and translation, applied in that order (a similarity transform).
+    // 32 bytes for float where a matrix with its inverse takes 128, inverses and
+    // interpolation stay cheap and exact.
+    template<typename T>
+    class YAM_VECTOR_ALIGN RigidTransformT {
+    public:
+        using Scalar = T;
+        using Vector3 = Vector3T<T>;
+        using Quaternion = QuaternionT<T>;
+
+        Quaternion rotation;
+        // Scalars, so the layout is the same with every SIMD backend.
+        // Translation() and SetTranslation() convert.
+        T translation[3];
+        T scale;
+
+        // Identity
+        constexpr RigidTransformT() : rotation(), translation{0, 0, 0}, scale(1) {}
+
+        constexpr RigidTransformT(const Quaternion& rotation, const Vector3& translation, T scale = 1)
+            : rotation(rotation)
+              , translation{translation.x, translation.y, translation.z}
+              , scale(scale) {}
+
+        constexpr Vector3 Translation() const { return {translation[0], translation[1], translation[2]}; }
+
+        constexpr void SetTranslation(const Vector3& value) {
+            translation[0] = value.x;
+            translation[1] = value.y;
+            translation[2] = value.z;
+        }
+
+        // Per component like Rotate, so the whole transform stays in scalar registers
+        constexpr Vector3 TransformPoint(const Vector3& point) const {
+            const Vector3 rotated = rotation.Rotate(point);
+            return {
+                rotated.x * scale + translation[0], rotated.y * scale + translation[1],
+                rotated.z * scale + translation[2]
+            };
+        }
+
+        constexpr Vector3 TransformVector(const Vector3& vector) const {
+            const Vector3 rotated = rotation.Rotate(vector);
+            return {rotated.x * scale, rotated.y * scale, rotated.z * scale};
+        }
+
+        // Uniform scale keeps normals perpendicular, they only need the rotation
+        constexpr Vector3 TransformNormal(const Vector3& normal) const {
+            return rotation.Rotate(normal);
+        }
+
+        // The result applies another first and then this
+        constexpr RigidTransformT operator*(const RigidTransformT& another) const {
+            return {rotation * another.rotation, TransformPoint(another.Translation()), scale * another.scale};
+        }
+
+        constexpr RigidTransformT Inverse() const {
+            const Quaternion inverseRotation = rotation.Conjugate();
+            const T inverseScale = 1 / scale;
+            return {inverseRotation, -inverseRotation.Rotate(Translation()) * inverseScale, inverseScale};
+        }
+
+        constexpr Mat4T<T> ToMat4() const {
+            Mat4T<T> result = rotation.ToMat4();
+            result[0] *= scale;
+            result[1] *= scale;
+            result[2] *= scale;
+            result[3] = Vector4T<T>{Translation(), 1};
+            return result;
+        }
+
+        // Fails when the matrix has shear, non uniform or negative scale or a projective row,
+        // tolerance is relative to the scale
+        static bool FromMat4(const Mat4T<T>& mat, RigidTransformT& result, T tolerance = T(1e-4)) {
+            const Vector3 axisX{mat[0]};
+            const Vector3 axisY{mat[1]};
+            const Vector3 axisZ{mat[2]};
+
+            const T scale = axisX.Length();
+            if (scale < SmallValue<T>)
+                return false;
+
+            const T maxError = tolerance * scale;
+            const T maxSquaredError = maxError * scale;
+            if (std::abs(axisY.Length() - scale) > maxError || std::abs(axisZ.Length() - scale) > maxError
+                || std::abs(axisX.Dot(axisY)) > maxSquaredError || std::abs(axisX.Dot(axisZ)) > maxSquaredError
+                || std::abs(axisY.Dot(axisZ)) > maxSquaredError || axisX.Cross(axisY).Dot(axisZ) < 0) {
+                return false;
+            }
+
+            if (mat[0][3] != 0 || mat[1][3] != 0 || mat[2][3] != 0 || mat[3][3] != 1)
+                return false;
+
+            result.rotation = Quaternion::FromMat4(mat * (1 / scale));
+            result.SetTranslation(Vector3{mat[3]});
+            result.scale = scale;
+            return true;
+        }
+
+        // Slerp of the rotation, linear translation and scale, for poses between animation keys
+        static RigidTransformT Interpolate(const RigidTransformT& a, const RigidTransformT& b, T t) {
+            return {
+                Quaternion::Slerp(a.rotation, b.rotation, t),
+                Vector3::Lerp(a.Translation(), b.Translation(), t),
+                a.scale + (b.scale - a.scale) * t
+            };
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const RigidTransformT& transform) {
+            os << "{rotation " << transform.rotation << ", translation " << transform.Translation()
+                << ", scale " << transform.scale << "}";
+            return os;
+        }
+    };
+
+    using RigidTransform = RigidTransformT<flt>;
+    using RigidTransformf = RigidTransformT<float>;
+    using RigidTransformd = RigidTransformT<double>;
+
+    static_assert(sizeof(RigidTransformf) == 32);
+    static_assert(std::is_trivially_copyable_v<RigidTransformf> && std::is_standard_layout_v<RigidTransformf>);
+    static_assert(std::is_trivially_copyable_v<RigidTransformd> && std::is_standard_layout_v<RigidTransformd>);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Algorithms.h"
+#include "BlueNoise.h"
+#include "Defines.h"
+#include "Vector3.h"
+
+namespace YAM{
+    // Source of the sample values of a path. A pixel sample is a point in [0, 1)^n, its dimensions
+    // are consumed in order (camera jitter first, then the same pairs every bounce), so a sampler
+    // can stratify each dimension across the samples of a pixel. State lives in mutable members
+    // like in Random, every render worker uses its own Clone().
+    class Sampler {
+    public:
+        virtual ~Sampler() = default;
+
+        virtual std::unique_ptr<Sampler> Clone() const = 0;
+
+        // Moves to sample sampleIndex of pixel x, y and back to dimension 0
+        virtual void StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const = 0;
+
+        virtual flt Get1D() const = 0;
+        virtual void Get2D(flt& outX, flt& outY) const = 0;
+
+        // Get2D mapped through SampleWarp
+        void GetDisk(flt& outX, flt& outY) const;
+        Vector3 GetSphereDirection() const;
+        Vector3 GetCosineHemisphereDirection(const Vector3& normal) const;
+
+        // Top 24 bits of a 32 bit sample as a float in [0, 1), never rounds up to 1
+        static flt ToUnitFloat(uint32_t bits) {
+            return static_cast<flt>(bits >> 8) * static_cast<flt>(1. / (1u << 24));
+        }
+    };
+
+    // Independent values from CounterRandom, the white noise reference
+    class RandomSampler : public Sampler {
+    private:
+        uint32_t seed;
+        mutable CounterRandom random;
+
+    public:
+        explicit RandomSampler(uint32_t seed);
+
+        std::unique_ptr<Sampler> Clone() const override;
+
+        void StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const override;
+
+        flt Get1D() const override;
+        void Get2D(flt& outX, flt& outY) const override;
+    };
+
+    // Owen scrambled Sobol points (Burley, "Practical Hash-based Owen Scrambling", JCGT 2020).
+    // Every 1D or 2D request takes the first one or two Sobol dimensions, a (0, 2) sequence, with its
+    // own index shuffle and scramble seeded from the pixel and the dimension. Samples of a pixel stay
+    // stratified in every pair of dimensions and neighbouring pixels are decorrelated.
+    class SobolSampler : public Sampler {
+    private:
+        uint32_t seed;
+
+        mutable uint32_t pixelSeed;
+        mutable uint32_t sampleIndex;
+        mutable uint32_t dimension;
+
+    public:
+        explicit SobolSampler(uint32_t seed);
+
+        std::unique_ptr<Sampler> Clone() const override;
+
+        void StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const override;
+
+        flt Get1D() const override;
+        void Get2D(flt& outX, flt& outY) const override;
+
+        // Sobol dimension 0 or 1 of index, as 32 bit fixed point
+        static uint32_t Sobol(uint32_t index, uint32_t sobolDimension);
+        // Owen scrambling of a 32 bit fixed point value in [0, 1)
+        static uint32_t NestedUniformScramble(uint32_t value, uint32_t scrambleSeed);
+
+    private:
+        static uint32_t ScrambledVanDerCorput(uint32_t index, uint32_t scrambleSeed);
+        uint32_t NextPatternSeed() const;
+    };
+
+    // For low sample counts. All pixels share one Owen scrambled Sobol sequence, shifted per pixel by a
+    // blue noise mask (Cranley-Patterson rotation). Errors of neighbouring pixels then differ in sign,
+    // so the remaining noise is high frequency and reads as much less noisy. Every dimension reads
+    // the mask at its own toroidal offset.
+    class BlueNoiseSampler : public Sampler {
+    private:
+        std::shared_ptr<const BlueNoiseMask> mask;
+        uint32_t seed;
+
+        mutable uint32_t pixelX;
+        mutable uint32_t pixelY;
+        mutable uint32_t sampleIndex;
+        mutable uint32_t dimension;
+
+    public:
+        BlueNoiseSampler(const std::shared_ptr<const BlueNoiseMask>& mask, uint32_t seed);
+
+        std::unique_ptr<Sampler> Clone() const override;
+
+        void StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const override;
+
+        flt Get1D() const override;
+        void Get2D(flt& outX, flt& outY) const override;
+
+    private:
+        uint32_t Shifted(uint32_t value, uint32_t dimensionKey, uint32_t channel) const;
+    };
+}
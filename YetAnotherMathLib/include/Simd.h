@@ -0,0 +1,143 @@
+#pragma once
+
+// Thin wrapper over 4-wide float registers, backend is chosen at build time
+// through YAM_SIMD (see YetAnotherMathLib/CMakeLists.txt).
+
+#include <type_traits>
+
+#include "Defines.h"
+
+#if defined(YAM_SIMD_SSE)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#define YAM_SIMD_ENABLED
+#elif defined(YAM_SIMD_NEON)
+#include <arm_neon.h>
+#define YAM_SIMD_ENABLED
+#endif
+
+#ifdef YAM_SIMD_ENABLED
+#define YAM_VECTOR_ALIGN alignas(16)
+#else
+#define YAM_VECTOR_ALIGN
+#endif
+
+#ifdef YAM_SIMD_ENABLED
+namespace YAM::Simd {
+    // Registers hold floats, vector types over other scalars keep the portable code
+    template<typename T>
+    inline constexpr bool Supports = std::is_same_v<T, float>;
+
+#if defined(YAM_SIMD_SSE)
+    using Float4 = __m128;
+
+    inline Float4 Load(const float* data) { return _mm_load_ps(data); }
+    inline void Store(float* data, Float4 value) { _mm_store_ps(data, value); }
+
+    // Three packed floats without alignment, w is zero. Never touches memory past data[2].
+    inline Float4 Load3(const float* data) {
+        const Float4 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+        return _mm_movelh_ps(xy, _mm_load_ss(data + 2));
+    }
+
+    inline void Store3(float* data, Float4 value) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(data), _mm_castps_si128(value));
+        _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+    }
+
+    inline Float4 Set(float value) { return _mm_set1_ps(value); }
+    inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+
+    inline Float4 Neg(Float4 value) { return _mm_xor_ps(value, _mm_set1_ps(-0.f)); }
+    inline Float4 Abs(Float4 value) { return _mm_andnot_ps(_mm_set1_ps(-0.f), value); }
+
+    inline float Dot3(Float4 a, Float4 b) {
+        const Float4 product = _mm_mul_ps(a, b);
+        const Float4 y = _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1));
+        const Float4 z = _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2));
+        return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(product, y), z));
+    }
+
+    inline float Dot4(Float4 a, Float4 b) {
+        const Float4 product = _mm_mul_ps(a, b);
+        const Float4 pairs = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+    }
+
+    // a * b.yzx - a.yzx * b gives the cross product in zxy order
+    inline Float4 Cross3(Float4 a, Float4 b) {
+        const Float4 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const Float4 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const Float4 crossZXY = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+        return _mm_shuffle_ps(crossZXY, crossZXY, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d) {
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+    }
+#elif defined(YAM_SIMD_NEON)
+    using Float4 = float32x4_t;
+
+    inline Float4 Load(const float* data) { return vld1q_f32(data); }
+    inline void Store(float* data, Float4 value) { vst1q_f32(data, value); }
+
+    inline Float4 Load3(const float* data) {
+        return vcombine_f32(vld1_f32(data), vset_lane_f32(data[2], vdup_n_f32(0.f), 0));
+    }
+
+    inline void Store3(float* data, Float4 value) {
+        vst1_f32(data, vget_low_f32(value));
+        vst1q_lane_f32(data + 2, value, 2);
+    }
+
+    inline Float4 Set(float value) { return vdupq_n_f32(value); }
+    inline Float4 Set(float x, float y, float z, float w) {
+        const float values[4] = {x, y, z, w};
+        return vld1q_f32(values);
+    }
+
+    inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    inline Float4 Div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+
+    inline Float4 Neg(Float4 value) { return vnegq_f32(value); }
+    inline Float4 Abs(Float4 value) { return vabsq_f32(value); }
+
+    inline float Dot3(Float4 a, Float4 b) {
+        const Float4 product = vmulq_f32(a, b);
+        return vgetq_lane_f32(product, 0) + vgetq_lane_f32(product, 1) + vgetq_lane_f32(product, 2);
+    }
+
+    inline float Dot4(Float4 a, Float4 b) {
+        return vaddvq_f32(vmulq_f32(a, b));
+    }
+
+    inline Float4 Cross3(Float4 a, Float4 b) {
+        const Float4 aYZX = vsetq_lane_f32(vgetq_lane_f32(a, 0), vextq_f32(a, a, 1), 2);
+        const Float4 bYZX = vsetq_lane_f32(vgetq_lane_f32(b, 0), vextq_f32(b, b, 1), 2);
+        const Float4 crossZXY = vsubq_f32(vmulq_f32(a, bYZX), vmulq_f32(aYZX, b));
+        return vsetq_lane_f32(vgetq_lane_f32(crossZXY, 0), vextq_f32(crossZXY, crossZXY, 1), 2);
+    }
+
+    inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d) {
+        const float32x4x2_t ab = vtrnq_f32(a, b);
+        const float32x4x2_t cd = vtrnq_f32(c, d);
+
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+#endif
+}
+#endif
@@ -6,157 +6,197 @@
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <type_traits>
 
+#include "Simd.h"
 #include "Vector4.h"
 
 namespace YAM{
-    class Vector3 {
+    // Trivially copyable value type over the scalar T. Arithmetic is constexpr, at runtime float
+    // vectors go through the SIMD backend when one is enabled. Storage stays three packed scalars,
+    // only the register a vector is loaded into has a fourth lane.
+    template<typename T>
+    class Vector3T {
     public:
-        flt x;
-        flt y;
-        flt z;
+        using Scalar = T;
 
-        Vector3() : x(0), y(0), z(0) {}
+        T x;
+        T y;
+        T z;
 
-        explicit Vector3(flt x) : x(x), y(x), z(x) {}
+        constexpr Vector3T() : x(0), y(0), z(0) {}
 
-        Vector3(flt X, flt Y, flt Z) : x(X), y(Y), z(Z) {}
+        constexpr explicit Vector3T(T x) : x(x), y(x), z(x) {}
 
-        explicit Vector3(const Vector4& vec4);
-        
-        flt Length() const { return std::sqrt(x * x + y * y + z * z); }
-        flt SquaredLength() const { return x * x + y * y + z * z; }
+        constexpr Vector3T(T X, T Y, T Z) : x(X), y(Y), z(Z) {}
 
-        Vector3 Normal() const {
-            const double length = this->Length();
-            if (length < SmallFloat)
-                return Vector3{0.};
+#ifdef YAM_SIMD_ENABLED
+        Simd::Float4 Load() const requires Simd::Supports<T> { return Simd::Load3(&x); }
 
-            return *this / length;
+        static Vector3T Store(Simd::Float4 value) requires Simd::Supports<T> {
+            Vector3T result;
+            Simd::Store3(&result.x, value);
+            return result;
         }
+#endif
 
-        Vector3 Sat() const {
-            Vector3 result;
+        constexpr explicit Vector3T(const Vector4T<T>& vec4) : Vector3T(vec4.x, vec4.y, vec4.z) {}
 
-            result.x = std::clamp(x, 0.f, 1.f);
-            result.y = std::clamp(y, 0.f, 1.f);
-            result.z = std::clamp(z, 0.f, 1.f);
-            
-            return result;
+        T Length() const { return std::sqrt(SquaredLength()); }
+        constexpr T SquaredLength() const { return Dot(*this); }
+
+        Vector3T Normal() const {
+            const T length = this->Length();
+            if (length < SmallValue<T>)
+                return Vector3T{T(0)};
+
+            return *this / length;
+        }
+
+        constexpr Vector3T Sat() const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Min(Simd::Max(Load(), Simd::Set(0.f)), Simd::Set(1.f)));
+            }
+#endif
+            return {std::clamp(x, T(0), T(1)), std::clamp(y, T(0), T(1)), std::clamp(z, T(0), T(1))};
         }
 
-        bool IsNear(const Vector3& vector3, flt error = SmallFloat) const {
+        bool IsNear(const Vector3T& vector3, T error = SmallValue<T>) const {
             return std::abs(this->Length() - vector3.Length()) < error;
         }
 
-        flt Dot(const Vector3& rhs) const { return x * rhs.x + y * rhs.y + z * rhs.z; }
-        static flt Dot(const Vector3& a, const Vector3& b) { return a.Dot(b); }
+        constexpr T Dot(const Vector3T& rhs) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Simd::Dot3(Load(), rhs.Load());
+            }
+#endif
+            return x * rhs.x + y * rhs.y + z * rhs.z;
+        }
 
-        flt Angle(const Vector3& rhs) const { return acos(this->Dot(rhs) / (this->Length() * rhs.Length())); }
+        static constexpr T Dot(const Vector3T& a, const Vector3T& b) { return a.Dot(b); }
 
-        Vector3 Abs() const { return {std::abs(x), std::abs(y), std::abs(z)}; }
+        T Angle(const Vector3T& rhs) const { return std::acos(this->Dot(rhs) / (this->Length() * rhs.Length())); }
+
+        constexpr Vector3T Abs() const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Abs(Load()));
+            }
+#endif
+            return {x < 0 ? -x : x, y < 0 ? -y : y, z < 0 ? -z : z};
+        }
 
-        Vector3 Cross(const Vector3& rhs) const {
+        constexpr Vector3T Cross(const Vector3T& rhs) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Cross3(Load(), rhs.Load()));
+            }
+#endif
             return {
                 this->y * rhs.z - this->z * rhs.y, this->z * rhs.x - this->x * rhs.z,
                 this->x * rhs.y - this->y * rhs.x
             };
         }
 
-        static Vector3 Cross(const Vector3& a, const Vector3& b) { return a.Cross(b); }
+        static constexpr Vector3T Cross(const Vector3T& a, const Vector3T& b) { return a.Cross(b); }
 
-        static Vector3 Lerp(const Vector3& a, const Vector3& b, float t) {
+        static constexpr Vector3T Lerp(const Vector3T& a, const Vector3T& b, T t) {
             return a + (b - a) * t;
         }
 
-        Vector3& operator=(Vector3 const& another) {
-            if (this == &another) {
-                return *this;
+        constexpr Vector3T operator-() const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Neg(Load()));
             }
-
-            this->x = another.x;
-            this->y = another.y;
-            this->z = another.z;
-            return *this;
+#endif
+            return {-x, -y, -z};
         }
 
-        Vector3 operator-() const {
-            Vector3 result;
-            result.x = -this->x;
-            result.y = -this->y;
-            result.z = -this->z;
-            return result;
-        }
-
-        Vector3 operator+(Vector3 const& another) const {
-            Vector3 result;
-            result.x = this->x + another.x;
-            result.y = this->y + another.y;
-            result.z = this->z + another.z;
-            return result;
+        constexpr Vector3T operator+(Vector3T const& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Add(Load(), another.Load()));
+            }
+#endif
+            return {x + another.x, y + another.y, z + another.z};
         }
 
-        Vector3 operator-(Vector3 const& another) const {
-            Vector3 result;
-            result.x = this->x - another.x;
-            result.y = this->y - another.y;
-            result.z = this->z - another.z;
-            return result;
+        constexpr Vector3T operator-(Vector3T const& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Sub(Load(), another.Load()));
+            }
+#endif
+            return {x - another.x, y - another.y, z - another.z};
         }
 
-        Vector3 Mul(const Vector3& another) const {
-            Vector3 result;
-            result.x = this->x * another.x;
-            result.y = this->y * another.y;
-            result.z = this->z * another.z;
-            return result;
+        constexpr Vector3T Mul(const Vector3T& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Mul(Load(), another.Load()));
+            }
+#endif
+            return {x * another.x, y * another.y, z * another.z};
         }
 
-        void operator+=(Vector3 const& another) { *this = *this + another; }
-        void operator-=(Vector3 const& another) { *this = *this - another; }
+        constexpr void operator+=(Vector3T const& another) { *this = *this + another; }
+        constexpr void operator-=(Vector3T const& another) { *this = *this - another; }
 
-        Vector3 operator*(flt const& scalar) const {
-            Vector3 result;
-            result.x = this->x * scalar;
-            result.y = this->y * scalar;
-            result.z = this->z * scalar;
-            return result;
+        constexpr Vector3T operator*(T const& scalar) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Mul(Load(), Simd::Set(scalar)));
+            }
+#endif
+            return {x * scalar, y * scalar, z * scalar};
         }
 
-        friend Vector3 operator*(flt scalar, const Vector3& vector) {
+        friend constexpr Vector3T operator*(T scalar, const Vector3T& vector) {
             return vector * scalar;
         }
 
-        Vector3 operator/(flt const& scalar) const {
-            Vector3 result;
-            result.x = this->x / scalar;
-            result.y = this->y / scalar;
-            result.z = this->z / scalar;
-            return result;
+        constexpr Vector3T operator/(T const& scalar) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Div(Load(), Simd::Set(scalar)));
+            }
+#endif
+            return {x / scalar, y / scalar, z / scalar};
         }
-        
-        flt operator[] (const uint8_t index) const {
-            const flt values[] = {x, y, z};
-            return values[index];
+
+        constexpr T operator[] (const uint8_t index) const {
+            return index == 0 ? x : index == 1 ? y : z;
         }
-        
-        flt& operator[] (const uint8_t index) {
-            flt* values[] = {&x, &y, &z};
-            return *values[index];
+
+        constexpr T& operator[] (const uint8_t index) {
+            return index == 0 ? x : index == 1 ? y : z;
         }
 
-        void operator*=(flt const& scalar) { *this = *this * scalar; }
-        void operator/=(flt const& scalar) { *this = *this / scalar; }
-        bool operator==(const Vector3& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+        constexpr void operator*=(T const& scalar) { *this = *this * scalar; }
+        constexpr void operator/=(T const& scalar) { *this = *this / scalar; }
+        constexpr bool operator==(const Vector3T& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
 
-        bool operator!=(const Vector3& rhs) const { return !(rhs == *this); }
-        bool operator<(const Vector3& rhs) const { return this->Length() < rhs.Length(); }
+        constexpr bool operator!=(const Vector3T& rhs) const { return !(rhs == *this); }
+        bool operator<(const Vector3T& rhs) const { return this->Length() < rhs.Length(); }
 
-        bool operator>(const Vector3& rhs) const { return rhs < *this; }
-        bool operator<=(const Vector3& rhs) const { return !(rhs < *this); }
-        bool operator>=(const Vector3& rhs) const { return !(*this < rhs); }
+        bool operator>(const Vector3T& rhs) const { return rhs < *this; }
+        bool operator<=(const Vector3T& rhs) const { return !(rhs < *this); }
+        bool operator>=(const Vector3T& rhs) const { return !(*this < rhs); }
 
-        friend std::ostream& operator<<(std::ostream& Os, const Vector3& vector3) {
+        friend std::ostream& operator<<(std::ostream& Os, const Vector3T& vector3) {
             Os << "[" << vector3.x << "," << vector3.y << "," << vector3.z << "]";
             return Os;
         }
@@ -166,7 +206,23 @@ namespace YAM{
             result << *this;
             return result.str();
         }
-        
-        friend class Vector4;
+
+        template<typename> friend class Vector4T;
     };
+
+    template<typename T>
+    constexpr Vector4T<T>::Vector4T(const Vector3T<T>& vec3, T w)
+        : x(vec3.x)
+          , y(vec3.y)
+          , z(vec3.z)
+          , w(w) {}
+
+    using Vector3 = Vector3T<flt>;
+    using Vector3f = Vector3T<float>;
+    using Vector3d = Vector3T<double>;
+
+    // Arrays of vectors can be memcpy'd and memory-mapped, with the same layout for every SIMD backend
+    static_assert(std::is_trivially_copyable_v<Vector3f> && std::is_standard_layout_v<Vector3f>);
+    static_assert(std::is_trivially_copyable_v<Vector3d> && std::is_standard_layout_v<Vector3d>);
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float) && sizeof(Vector3d) == 3 * sizeof(double));
 } // namespace SG
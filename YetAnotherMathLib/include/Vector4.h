@@ -2,115 +2,161 @@
 
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include "Defines.h"
+#include "Simd.h"
 
 namespace YAM{
-    class Vector3;
-    
-    class Vector4 {
+    template<typename T>
+    class Vector3T;
+
+    template<typename T>
+    class Mat4T;
+
+    template<typename T>
+    class Mat3x4T;
+
+    // Trivially copyable value type over the scalar T, see Vector3T
+    template<typename T>
+    class YAM_VECTOR_ALIGN Vector4T {
     private:
-        flt x;
-        flt y;
-        flt z;
-        flt w;
+        T x;
+        T y;
+        T z;
+        T w;
 
     public:
-        Vector4() : x(0), y(0), z(0), w(0) {};
-        explicit Vector4(flt x) : x(x), y(x), z(x), w(x) {};
-        Vector4(const Vector3& vec3, flt w);
-        Vector4(flt x, flt y, flt z, flt w) : x(x), y(y), z(z), w(w) {}
+        using Scalar = T;
 
-        flt Length() const { return std::sqrt(x * x + y * y + z * z + w * w); }
+        constexpr Vector4T() : x(0), y(0), z(0), w(0) {};
+        constexpr explicit Vector4T(T x) : x(x), y(x), z(x), w(x) {};
+        // Defined in Vector3.h, which is needed to have a Vector3T anyway
+        constexpr Vector4T(const Vector3T<T>& vec3, T w);
+        constexpr Vector4T(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
 
-        Vector4 Normal() const {
-            double length = this->Length();
-            if (length < std::numeric_limits<float>::min())
-                return Vector4{0.};
+#ifdef YAM_SIMD_ENABLED
+        Simd::Float4 Load() const requires Simd::Supports<T> { return Simd::Load(&x); }
 
-            return *this / length;
+        static Vector4T Store(Simd::Float4 value) requires Simd::Supports<T> {
+            Vector4T result;
+            Simd::Store(&result.x, value);
+            return result;
+        }
+#endif
+
+        T Length() const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                return std::sqrt(Simd::Dot4(Load(), Load()));
+            }
+#endif
+            return std::sqrt(x * x + y * y + z * z + w * w);
         }
 
-        flt Dot(const Vector4& rhs) const { return x * rhs.x + y * rhs.y + z * rhs.z; }
-        static flt Dot(const Vector4& a, Vector4& b) { return a.Dot(b); }
+        Vector4T Normal() const {
+            const T length = this->Length();
+            if (length < std::numeric_limits<T>::min())
+                return Vector4T{T(0)};
 
-        flt Angle(Vector4& rhs) const { return acos(this->Dot(rhs) / (this->Length() * rhs.Length())); }
+            return *this / length;
+        }
 
-        Vector4& operator=(Vector4 const& another) {
-            if (this == &another) {
-                return *this;
+        // Only xyz take part, w is treated as the homogeneous coordinate
+        constexpr T Dot(const Vector4T& rhs) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Simd::Dot3(Load(), rhs.Load());
             }
+#endif
+            return x * rhs.x + y * rhs.y + z * rhs.z;
+        }
+        static constexpr T Dot(const Vector4T& a, Vector4T& b) { return a.Dot(b); }
 
-            this->x = another.x;
-            this->y = another.y;
-            this->z = another.z;
-            this->w = another.w;
-            return *this;
+        T Angle(Vector4T& rhs) const { return std::acos(this->Dot(rhs) / (this->Length() * rhs.Length())); }
+
+        constexpr Vector4T operator-() const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Neg(Load()));
+            }
+#endif
+            return {-x, -y, -z, -w};
         }
 
-        Vector4 operator-() const {
-            Vector4 result;
-            result.x = -this->x;
-            result.y = -this->y;
-            result.z = -this->z;
-            result.w = -this->w;
-            return result;
+        constexpr Vector4T operator+(Vector4T const& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Add(Load(), another.Load()));
+            }
+#endif
+            return {x + another.x, y + another.y, z + another.z, w + another.w};
         }
 
-        Vector4 operator+(Vector4 const& another) const {
-            Vector4 result;
-            result.x = this->x + another.x;
-            result.y = this->y + another.y;
-            result.z = this->z + another.z;
-            result.w = this->w + another.w;
-            return result;
+        constexpr T operator[] (const uint8_t index) const {
+            return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
         }
 
-        flt operator[] (const uint8_t index) const {
-            const flt values[] = {x, y, z, w};
-            return values[index];
+        constexpr T& operator[] (const uint8_t index) {
+            return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
         }
-        
-        flt& operator[] (const uint8_t index) {
-            flt* values[] = {&x, &y, &z, &w};
-            return *values[index];
+
+        constexpr Vector4T operator-(Vector4T const& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Sub(Load(), another.Load()));
+            }
+#endif
+            return *this + (-another);
         }
 
-        Vector4 operator-(Vector4 const& another) const {
-            Vector4 result = *this + (-another);
-            return result;
+        constexpr Vector4T Mul(const Vector4T& another) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Mul(Load(), another.Load()));
+            }
+#endif
+            return {x * another.x, y * another.y, z * another.z, w * another.w};
         }
 
-        void operator+=(Vector4 const& another) { *this = *this + another; }
-        void operator-=(Vector4 const& another) { *this = *this - another; }
+        constexpr void operator+=(Vector4T const& another) { *this = *this + another; }
+        constexpr void operator-=(Vector4T const& another) { *this = *this - another; }
 
-        Vector4 operator*(flt const& scalar) const {
-            Vector4 result;
-            result.x = this->x * scalar;
-            result.y = this->y * scalar;
-            result.z = this->z * scalar;
-            result.w = this->w * scalar;
-            return result;
+        constexpr Vector4T operator*(T const& scalar) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Mul(Load(), Simd::Set(scalar)));
+            }
+#endif
+            return {x * scalar, y * scalar, z * scalar, w * scalar};
         }
 
-        Vector4 operator/(flt const& scalar) const {
-            Vector4 result;
-            result.x = this->x / scalar;
-            result.y = this->y / scalar;
-            result.z = this->z / scalar;
-            result.w = this->w / scalar;
-            return result;
+        constexpr Vector4T operator/(T const& scalar) const {
+#ifdef YAM_SIMD_ENABLED
+            if constexpr (Simd::Supports<T>) {
+                if (!std::is_constant_evaluated())
+                    return Store(Simd::Div(Load(), Simd::Set(scalar)));
+            }
+#endif
+            return {x / scalar, y / scalar, z / scalar, w / scalar};
         }
 
-        void operator*=(flt const& scalar) { *this = *this * scalar; }
-        void operator/=(flt const& scalar) { *this = *this / scalar; }
-        bool operator==(const Vector4& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w; }
-        bool operator!=(const Vector4& rhs) const { return !(rhs == *this); }
+        constexpr void operator*=(T const& scalar) { *this = *this * scalar; }
+        constexpr void operator/=(T const& scalar) { *this = *this / scalar; }
+        constexpr bool operator==(const Vector4T& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w; }
+        constexpr bool operator!=(const Vector4T& rhs) const { return !(rhs == *this); }
 
-        friend std::ostream& operator<<(std::ostream& os, const Vector4& vector4) {
+        friend std::ostream& operator<<(std::ostream& os, const Vector4T& vector4) {
             os << "[" << vector4.x << "," << vector4.y << "," << vector4.z << "," << vector4.w << "]";
             return os;
         }
@@ -120,8 +166,16 @@ namespace YAM{
             result << *this;
             return result.str();
         }
-        
-        friend class Mat4;
-        friend class Vector3;
+
+        template<typename> friend class Mat4T;
+        template<typename> friend class Mat3x4T;
+        template<typename> friend class Vector3T;
     };
+
+    using Vector4 = Vector4T<flt>;
+    using Vector4f = Vector4T<float>;
+    using Vector4d = Vector4T<double>;
+
+    static_assert(std::is_trivially_copyable_v<Vector4f> && std::is_standard_layout_v<Vector4f>);
+    static_assert(std::is_trivially_copyable_v<Vector4d> && std::is_standard_layout_v<Vector4d>);
 } // namespace SG
@@ -0,0 +1,57 @@
+#include "AliasTable.h"
+
+#include <algorithm>
+
+namespace YAM{
+    AliasTable::AliasTable() = default;
+
+    AliasTable::AliasTable(const std::vector<flt>& weights) {
+        // Sums of many small weights lose too much in float
+        double sum = 0.;
+        for (const flt weight : weights) {
+            sum += std::max(static_cast<double>(weight), 0.);
+        }
+
+        if (weights.empty() || !(sum > 0.)) {
+            return;
+        }
+
+        const uint32_t count = static_cast<uint32_t>(weights.size());
+        buckets.resize(count);
+        pdfs.resize(count);
+
+        // Weights scaled so the average bucket is exactly full
+        std::vector<double> scaled(count);
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (uint32_t i = 0; i < count; ++i) {
+            const double weight = std::max(static_cast<double>(weights[i]), 0.);
+            pdfs[i] = static_cast<flt>(weight / sum);
+            scaled[i] = weight * count / sum;
+            (scaled[i] < 1. ? small : large).push_back(i);
+        }
+
+        // Every underfull bucket is topped up from one overfull bucket
+        while (!small.empty() && !large.empty()) {
+            const uint32_t under = small.back();
+            small.pop_back();
+            const uint32_t over = large.back();
+
+            buckets[under] = {static_cast<flt>(scaled[under]), over};
+
+            scaled[over] -= 1. - scaled[under];
+            if (scaled[over] < 1.) {
+                large.pop_back();
+                small.push_back(over);
+            }
+        }
+
+        // What is left is full up to rounding errors
+        for (const uint32_t i : large) {
+            buckets[i] = {1.f, i};
+        }
+        for (const uint32_t i : small) {
+            buckets[i] = {1.f, i};
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#include "BlueNoise.h"
+
+#include <bit>
+#include <fstream>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+
+namespace YAM{
+    namespace {
+        // "YABN" in a little endian file
+        constexpr uint32_t FileMagic = 0x4e424159;
+        constexpr uint32_t FileVersion = 1;
+
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t size;
+            uint32_t channels;
+        };
+
+        bool IsValidSize(uint32_t size) {
+            return size >= 2 && size <= BlueNoiseMask::MaxSize && std::has_single_bit(size);
+        }
+    }
+
+    BlueNoiseMask::BlueNoiseMask()
+        : size(0)
+          , channels(0)
+          , sizeLog2(0) {}
+
+    BlueNoiseMask::BlueNoiseMask(uint32_t size, uint32_t channels, std::vector<uint16_t> ranks)
+        : size(size)
+          , channels(channels)
+          , sizeLog2(std::countr_zero(size))
+          , ranks(std::move(ranks)) {
+        BuildOffsets();
+    }
+
+    bool BlueNoiseMask::Load(const std::string& path, BlueNoiseMask& outMask) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file) {
+            spdlog::error("Cannot open blue noise mask {}", path);
+            return false;
+        }
+
+        FileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != FileMagic || header.version != FileVersion
+            || !IsValidSize(header.size) || header.channels == 0) {
+            spdlog::error("{} is not a blue noise mask", path);
+            return false;
+        }
+
+        std::vector<uint16_t> ranks(static_cast<size_t>(header.size) * header.size * header.channels);
+        file.read(reinterpret_cast<char*>(ranks.data()), ranks.size() * sizeof(uint16_t));
+        if (!file) {
+            spdlog::error("Blue noise mask {} is truncated", path);
+            return false;
+        }
+
+        outMask = BlueNoiseMask(header.size, header.channels, std::move(ranks));
+        spdlog::info("Loaded {}x{} blue noise mask with {} channels from {}",
+                     header.size, header.size, header.channels, path);
+        return true;
+    }
+
+    bool BlueNoiseMask::Save(const std::string& path) const {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file) {
+            spdlog::error("Cannot create blue noise mask {}", path);
+            return false;
+        }
+
+        const FileHeader header{FileMagic, FileVersion, size, channels};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(ranks.data()), ranks.size() * sizeof(uint16_t));
+
+        return static_cast<bool>(file);
+    }
+
+    void BlueNoiseMask::BuildOffsets() {
+        // size * size ranks split [0, 2^32) into equal intervals
+        const uint32_t rankShift = 32 - 2 * sizeLog2;
+        const uint32_t halfInterval = rankShift > 0 ? 1u << (rankShift - 1) : 0;
+
+        offsets.resize(ranks.size());
+        for (size_t i = 0; i < ranks.size(); ++i) {
+            offsets[i] = (static_cast<uint32_t>(ranks[i]) << rankShift) + halfInterval;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace YAM{
+    namespace {
+        constexpr int NoOverride = -1;
+
+        std::atomic<int> levelOverride{NoOverride};
+
+        IsaLevel DetectLevel() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+
+            // Also checks that the OS saves the wider registers
+            if (__builtin_cpu_supports("avx512f")) {
+                return IsaLevel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return IsaLevel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.2")) {
+                return IsaLevel::SSE42;
+            }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            const bool sse42 = (info[2] & (1 << 20)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+
+            const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+            const bool osAvx = (xcr0 & 0x6) == 0x6;
+            const bool osAvx512 = (xcr0 & 0xe6) == 0xe6;
+
+            if (maxLeaf >= 7) {
+                __cpuidex(info, 7, 0);
+                if (osAvx512 && (info[1] & (1 << 16)) != 0) {
+                    return IsaLevel::AVX512;
+                }
+                if (osAvx && (info[1] & (1 << 5)) != 0) {
+                    return IsaLevel::AVX2;
+                }
+            }
+            if (sse42) {
+                return IsaLevel::SSE42;
+            }
+#endif
+            return IsaLevel::Scalar;
+        }
+
+        IsaLevel StartupLevel() {
+            const IsaLevel detected = CpuFeatures::Detect();
+
+            IsaLevel requested;
+            const char* name = std::getenv("YAM_ISA");
+            if (name != nullptr && CpuFeatures::FromString(name, requested)) {
+                return std::min(requested, detected);
+            }
+
+            return detected;
+        }
+    }
+
+    IsaLevel CpuFeatures::Detect() {
+        static const IsaLevel detected = DetectLevel();
+        return detected;
+    }
+
+    IsaLevel CpuFeatures::GetLevel() {
+        const int overridden = levelOverride.load(std::memory_order_relaxed);
+        if (overridden != NoOverride) {
+            return static_cast<IsaLevel>(overridden);
+        }
+
+        static const IsaLevel startupLevel = StartupLevel();
+        return startupLevel;
+    }
+
+    void CpuFeatures::SetLevel(IsaLevel level) {
+        levelOverride.store(static_cast<int>(std::min(level, Detect())), std::memory_order_relaxed);
+    }
+
+    void CpuFeatures::ResetLevel() {
+        levelOverride.store(NoOverride, std::memory_order_relaxed);
+    }
+
+    const char* CpuFeatures::ToString(IsaLevel level) {
+        switch (level) {
+        case IsaLevel::SSE42:
+            return "sse4.2";
+        case IsaLevel::AVX2:
+            return "avx2";
+        case IsaLevel::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+
+    bool CpuFeatures::FromString(const char* name, IsaLevel& outLevel) {
+        for (const IsaLevel level : {IsaLevel::Scalar, IsaLevel::SSE42, IsaLevel::AVX2, IsaLevel::AVX512}) {
+            if (std::strcmp(name, ToString(level)) == 0) {
+                outLevel = level;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,431 @@
+#include "Kernels.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Algorithms.h"
+#include "FastMath.h"
+
+// Every vectorized kernel is compiled once per instruction set through target attributes,
+// other compilers get a single copy built with the global flags
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YAM_KERNELS_MULTI_ISA
+#define YAM_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace YAM{
+    namespace {
+        constexpr uint32_t Miss = std::numeric_limits<uint32_t>::max();
+        constexpr uint32_t ChunkSize = 16;
+
+        // Triangles of one chunk in SoA form, unused lanes stay degenerate and never hit
+        struct TriangleChunk {
+            alignas(64) flt a[3][ChunkSize];
+            alignas(64) flt b[3][ChunkSize];
+            alignas(64) flt c[3][ChunkSize];
+
+            YAM_FORCE_INLINE void Set(uint32_t lane, const Vector3& posA, const Vector3& posB, const Vector3& posC) {
+                a[0][lane] = posA.x;
+                a[1][lane] = posA.y;
+                a[2][lane] = posA.z;
+                b[0][lane] = posB.x;
+                b[1][lane] = posB.y;
+                b[2][lane] = posB.z;
+                c[0][lane] = posC.x;
+                c[1][lane] = posC.y;
+                c[2][lane] = posC.z;
+            }
+
+            YAM_FORCE_INLINE void Clear(uint32_t firstLane) {
+                for (uint32_t lane = firstLane; lane < ChunkSize; ++lane) {
+                    Set(lane, Vector3{}, Vector3{}, Vector3{});
+                }
+            }
+        };
+
+        // Same operations as LinearMath::FindIntersection, one triangle per lane
+        YAM_FORCE_INLINE uint32_t ClosestInChunk(const Ray& ray, const TriangleChunk& chunk, uint32_t lanes,
+                                                 TriangleHit& inOutHit) {
+            alignas(64) flt distance[ChunkSize];
+            alignas(64) flt barU[ChunkSize];
+            alignas(64) flt barV[ChunkSize];
+
+            const flt px = ray.point.x;
+            const flt py = ray.point.y;
+            const flt pz = ray.point.z;
+            const flt dx = ray.direction.x;
+            const flt dy = ray.direction.y;
+            const flt dz = ray.direction.z;
+
+#pragma omp simd
+            for (uint32_t lane = 0; lane < ChunkSize; ++lane) {
+                const flt abx = chunk.b[0][lane] - chunk.a[0][lane];
+                const flt aby = chunk.b[1][lane] - chunk.a[1][lane];
+                const flt abz = chunk.b[2][lane] - chunk.a[2][lane];
+                const flt acx = chunk.c[0][lane] - chunk.a[0][lane];
+                const flt acy = chunk.c[1][lane] - chunk.a[1][lane];
+                const flt acz = chunk.c[2][lane] - chunk.a[2][lane];
+
+                const flt nx = aby * acz - abz * acy;
+                const flt ny = abz * acx - abx * acz;
+                const flt nz = abx * acy - aby * acx;
+
+                const flt rx = px - chunk.a[0][lane];
+                const flt ry = py - chunk.a[1][lane];
+                const flt rz = pz - chunk.a[2][lane];
+
+                const flt qx = ry * dz - rz * dy;
+                const flt qy = rz * dx - rx * dz;
+                const flt qz = rx * dy - ry * dx;
+
+                const flt det = -(dx * nx + dy * ny + dz * nz);
+                const flt invDet = 1 / det;
+
+                const flt t = (rx * nx + ry * ny + rz * nz) * invDet;
+                const flt u = (acx * qx + acy * qy + acz * qz) * invDet;
+                const flt v = -(abx * qx + aby * qy + abz * qz) * invDet;
+                const flt w = 1.f - u - v;
+
+                // Bitwise and keeps the loop free of branches
+                const bool hit = !(det < SmallFloat) & !(t < SmallFloat) & (u >= 0.f) & (v >= 0.f) & (w >= 0.f);
+                distance[lane] = hit ? t : std::numeric_limits<flt>::infinity();
+                barU[lane] = u;
+                barV[lane] = v;
+            }
+
+            uint32_t closestLane = Miss;
+            for (uint32_t lane = 0; lane < lanes; ++lane) {
+                if (distance[lane] < inOutHit.distance) {
+                    inOutHit = {distance[lane], barU[lane], barV[lane]};
+                    closestLane = lane;
+                }
+            }
+
+            return closestLane;
+        }
+
+        YAM_FORCE_INLINE uint32_t IntersectTrianglesBody(const Ray& ray, const Vector3* positions,
+                                                         const TriangleIndices* triangles, uint32_t count,
+                                                         TriangleHit& inOutHit) {
+            TriangleChunk chunk;
+            uint32_t closest = Miss;
+
+            for (uint32_t first = 0; first < count; first += ChunkSize) {
+                const uint32_t lanes = std::min(ChunkSize, count - first);
+                for (uint32_t lane = 0; lane < lanes; ++lane) {
+                    const TriangleIndices& tri = triangles[first + lane];
+                    chunk.Set(lane, positions[tri.a], positions[tri.b], positions[tri.c]);
+                }
+                chunk.Clear(lanes);
+
+                const uint32_t lane = ClosestInChunk(ray, chunk, lanes, inOutHit);
+                if (lane != Miss) {
+                    closest = first + lane;
+                }
+            }
+
+            return closest;
+        }
+
+        YAM_FORCE_INLINE uint32_t IntersectTrianglePositionsBody(const Ray& ray, const TrianglePositions* triangles,
+                                                                 uint32_t count, TriangleHit& inOutHit) {
+            TriangleChunk chunk;
+            uint32_t closest = Miss;
+
+            for (uint32_t first = 0; first < count; first += ChunkSize) {
+                const uint32_t lanes = std::min(ChunkSize, count - first);
+                for (uint32_t lane = 0; lane < lanes; ++lane) {
+                    const TrianglePositions& tri = triangles[first + lane];
+                    chunk.Set(lane, tri.posA, tri.posB, tri.posC);
+                }
+                chunk.Clear(lanes);
+
+                const uint32_t lane = ClosestInChunk(ray, chunk, lanes, inOutHit);
+                if (lane != Miss) {
+                    closest = first + lane;
+                }
+            }
+
+            return closest;
+        }
+
+        // Same slab test as LinearMath::FindIntersection(TraversalRay, AABB)
+        YAM_FORCE_INLINE uint32_t IntersectBoxesBody(const TraversalRay& ray, const AABB* boxes, uint32_t count,
+                                                     uint8_t* outHits) {
+            const flt ix = ray.invDirection.x;
+            const flt iy = ray.invDirection.y;
+            const flt iz = ray.invDirection.z;
+            const flt px = ray.point.x;
+            const flt py = ray.point.y;
+            const flt pz = ray.point.z;
+            const bool negativeX = ray.sign[0];
+            const bool negativeY = ray.sign[1];
+            const bool negativeZ = ray.sign[2];
+            constexpr flt infinity = std::numeric_limits<flt>::infinity();
+
+            uint32_t hitCount = 0;
+
+#pragma omp simd reduction(+:hitCount)
+            for (uint32_t i = 0; i < count; ++i) {
+                const AABB& box = boxes[i];
+
+                // Both planes are computed and then picked by sign, selecting the loads would need gathers
+                const flt minX = (box.min.x - px) * ix;
+                const flt minY = (box.min.y - py) * iy;
+                const flt minZ = (box.min.z - pz) * iz;
+                const flt maxX = (box.max.x - px) * ix;
+                const flt maxY = (box.max.y - py) * iy;
+                const flt maxZ = (box.max.z - pz) * iz;
+
+                const flt entryX = negativeX ? maxX : minX;
+                const flt entryY = negativeY ? maxY : minY;
+                const flt entryZ = negativeZ ? maxZ : minZ;
+
+                const flt exitX = negativeX ? minX : maxX;
+                const flt exitY = negativeY ? minY : maxY;
+                const flt exitZ = negativeZ ? minZ : maxZ;
+
+                // NaN slabs of rays lying in a bounding plane fail the comparisons and are skipped
+                flt entry = -infinity;
+                entry = entryX > entry ? entryX : entry;
+                entry = entryY > entry ? entryY : entry;
+                entry = entryZ > entry ? entryZ : entry;
+
+                flt exit = infinity;
+                exit = exitX < exit ? exitX : exit;
+                exit = exitY < exit ? exitY : exit;
+                exit = exitZ < exit ? exitZ : exit;
+                exit *= LinearMath::SlabExitScale;
+
+                const uint8_t hit = (exit >= 0.f) & (entry <= exit);
+                outHits[i] = hit;
+                hitCount += hit;
+            }
+
+            return hitCount;
+        }
+
+        // PCG needs a variable shift per lane, AVX2 and AVX512 have one, SSE gets it emulated
+        YAM_FORCE_INLINE void FillRandomIntsBody(uint32_t streamKey, uint32_t counter, uint32_t* out, uint32_t count) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                out[i] = CounterRandom::Hash(streamKey, counter + i);
+            }
+        }
+
+        YAM_FORCE_INLINE void FillRandomBody(uint32_t streamKey, uint32_t counter, flt* out, uint32_t count) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t z = CounterRandom::Hash(streamKey, counter + i);
+
+                // 24 bits fit the mantissa exactly, so 1 is never reached
+                out[i] = static_cast<flt>(static_cast<int32_t>(z >> 8)) * 0x1p-24f;
+            }
+        }
+
+        YAM_FORCE_INLINE uint8_t ToByte(flt value) {
+            const flt saturated = value < 0.f ? 0.f : (1.f < value ? 1.f : value);
+            return static_cast<uint8_t>(255.f * saturated);
+        }
+
+        YAM_FORCE_INLINE void TonemapBody(const Vector3* colors, uint32_t count, flt divisor, uint32_t* outPixels) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t r = ToByte(colors[i].x / divisor);
+                const uint32_t g = ToByte(colors[i].y / divisor);
+                const uint32_t b = ToByte(colors[i].z / divisor);
+
+                outPixels[i] = 0xff000000u | r << 16 | g << 8 | b;
+            }
+        }
+
+        YAM_FORCE_INLINE void SinCosBody(const float* values, uint32_t count, float* outSin, float* outCos) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                FastMath::SinCos(values[i], outSin[i], outCos[i]);
+            }
+        }
+
+        YAM_FORCE_INLINE void LogBody(const float* values, uint32_t count, float* outValues) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Log(values[i]);
+            }
+        }
+
+        YAM_FORCE_INLINE void ExpBody(const float* values, uint32_t count, float* outValues) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Exp(values[i]);
+            }
+        }
+
+        YAM_FORCE_INLINE void PowBody(const float* bases, const float* exponents, uint32_t count, float* outValues) {
+#pragma omp simd
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Pow(bases[i], exponents[i]);
+            }
+        }
+
+        // Reference versions, straight loops over the scalar LinearMath functions
+        uint32_t IntersectTrianglesScalar(const Ray& ray, const Vector3* positions, const TriangleIndices* triangles,
+                                          uint32_t count, TriangleHit& inOutHit) {
+            uint32_t closest = Miss;
+            for (uint32_t i = 0; i < count; ++i) {
+                const TriangleIndices& tri = triangles[i];
+
+                TriangleHit hit;
+                if (LinearMath::FindIntersection(ray, positions[tri.a], positions[tri.b], positions[tri.c], hit)
+                    && hit.distance < inOutHit.distance) {
+                    inOutHit = hit;
+                    closest = i;
+                }
+            }
+
+            return closest;
+        }
+
+        uint32_t IntersectTrianglePositionsScalar(const Ray& ray, const TrianglePositions* triangles, uint32_t count,
+                                                  TriangleHit& inOutHit) {
+            uint32_t closest = Miss;
+            for (uint32_t i = 0; i < count; ++i) {
+                const TrianglePositions& tri = triangles[i];
+
+                TriangleHit hit;
+                if (LinearMath::FindIntersection(ray, tri.posA, tri.posB, tri.posC, hit)
+                    && hit.distance < inOutHit.distance) {
+                    inOutHit = hit;
+                    closest = i;
+                }
+            }
+
+            return closest;
+        }
+
+        uint32_t IntersectBoxesScalar(const TraversalRay& ray, const AABB* boxes, uint32_t count, uint8_t* outHits) {
+            uint32_t hitCount = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                outHits[i] = LinearMath::FindIntersection(ray, boxes[i]);
+                hitCount += outHits[i];
+            }
+
+            return hitCount;
+        }
+
+        void FillRandomIntsScalar(uint32_t streamKey, uint32_t counter, uint32_t* out, uint32_t count) {
+            FillRandomIntsBody(streamKey, counter, out, count);
+        }
+
+        void FillRandomScalar(uint32_t streamKey, uint32_t counter, flt* out, uint32_t count) {
+            FillRandomBody(streamKey, counter, out, count);
+        }
+
+        void TonemapScalar(const Vector3* colors, uint32_t count, flt divisor, uint32_t* outPixels) {
+            for (uint32_t i = 0; i < count; ++i) {
+                outPixels[i] = Color::FromVector(colors[i] / divisor).hex;
+            }
+        }
+
+        void SinCosScalar(const float* values, uint32_t count, float* outSin, float* outCos) {
+            for (uint32_t i = 0; i < count; ++i) {
+                FastMath::SinCos(values[i], outSin[i], outCos[i]);
+            }
+        }
+
+        void LogScalar(const float* values, uint32_t count, float* outValues) {
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Log(values[i]);
+            }
+        }
+
+        void ExpScalar(const float* values, uint32_t count, float* outValues) {
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Exp(values[i]);
+            }
+        }
+
+        void PowScalar(const float* bases, const float* exponents, uint32_t count, float* outValues) {
+            for (uint32_t i = 0; i < count; ++i) {
+                outValues[i] = FastMath::Pow(bases[i], exponents[i]);
+            }
+        }
+
+#define YAM_DEFINE_KERNELS(Suffix, Target)                                                                    \
+        Target uint32_t IntersectTriangles##Suffix(const Ray& ray, const Vector3* positions,                  \
+                                                   const TriangleIndices* triangles, uint32_t count,          \
+                                                   TriangleHit& inOutHit) {                                   \
+            return IntersectTrianglesBody(ray, positions, triangles, count, inOutHit);                        \
+        }                                                                                                     \
+        Target uint32_t IntersectTrianglePositions##Suffix(const Ray& ray, const TrianglePositions* triangles, \
+                                                           uint32_t count, TriangleHit& inOutHit) {           \
+            return IntersectTrianglePositionsBody(ray, triangles, count, inOutHit);                           \
+        }                                                                                                     \
+        Target uint32_t IntersectBoxes##Suffix(const TraversalRay& ray, const AABB* boxes, uint32_t count,    \
+                                               uint8_t* outHits) {                                            \
+            return IntersectBoxesBody(ray, boxes, count, outHits);                                            \
+        }                                                                                                     \
+        Target void FillRandomInts##Suffix(uint32_t streamKey, uint32_t counter, uint32_t* out,               \
+                                           uint32_t count) {                                                  \
+            FillRandomIntsBody(streamKey, counter, out, count);                                               \
+        }                                                                                                     \
+        Target void FillRandom##Suffix(uint32_t streamKey, uint32_t counter, flt* out, uint32_t count) {      \
+            FillRandomBody(streamKey, counter, out, count);                                                   \
+        }                                                                                                     \
+        Target void Tonemap##Suffix(const Vector3* colors, uint32_t count, flt divisor, uint32_t* outPixels) { \
+            TonemapBody(colors, count, divisor, outPixels);                                                   \
+        }                                                                                                     \
+        Target void SinCos##Suffix(const float* values, uint32_t count, float* outSin, float* outCos) {       \
+            SinCosBody(values, count, outSin, outCos);                                                        \
+        }                                                                                                     \
+        Target void Log##Suffix(const float* values, uint32_t count, float* outValues) {                      \
+            LogBody(values, count, outValues);                                                                \
+        }                                                                                                     \
+        Target void Exp##Suffix(const float* values, uint32_t count, float* outValues) {                      \
+            ExpBody(values, count, outValues);                                                                \
+        }                                                                                                     \
+        Target void Pow##Suffix(const float* bases, const float* exponents, uint32_t count,                   \
+                                float* outValues) {                                                           \
+            PowBody(bases, exponents, count, outValues);                                                      \
+        }                                                                                                     \
+        constexpr KernelTable MakeTable##Suffix(IsaLevel level) {                                             \
+            return {level, IntersectTriangles##Suffix, IntersectTrianglePositions##Suffix,                    \
+                    IntersectBoxes##Suffix, FillRandomInts##Suffix, FillRandom##Suffix, Tonemap##Suffix,      \
+                    SinCos##Suffix, Log##Suffix, Exp##Suffix, Pow##Suffix};                                   \
+        }
+
+#ifdef YAM_KERNELS_MULTI_ISA
+        YAM_DEFINE_KERNELS(SSE42, YAM_TARGET("sse4.2"))
+        YAM_DEFINE_KERNELS(AVX2, YAM_TARGET("avx2"))
+        YAM_DEFINE_KERNELS(AVX512, YAM_TARGET("avx512f,prefer-vector-width=512"))
+#else
+        YAM_DEFINE_KERNELS(Vectorized, )
+#endif
+
+#undef YAM_DEFINE_KERNELS
+    }
+
+    const KernelTable& Kernels::Get() {
+        return Get(CpuFeatures::GetLevel());
+    }
+
+    const KernelTable& Kernels::Get(IsaLevel level) {
+        static const KernelTable tables[] = {
+            {
+                IsaLevel::Scalar, IntersectTrianglesScalar, IntersectTrianglePositionsScalar,
+                IntersectBoxesScalar, FillRandomIntsScalar, FillRandomScalar, TonemapScalar,
+                SinCosScalar, LogScalar, ExpScalar, PowScalar
+            },
+#ifdef YAM_KERNELS_MULTI_ISA
+            MakeTableSSE42(IsaLevel::SSE42),
+            MakeTableAVX2(IsaLevel::AVX2),
+            MakeTableAVX512(IsaLevel::AVX512),
+#else
+            MakeTableVectorized(IsaLevel::SSE42),
+            MakeTableVectorized(IsaLevel::AVX2),
+            MakeTableVectorized(IsaLevel::AVX512),
+#endif
+        };
+
+        return tables[static_cast<uint8_t>(std::min(level, CpuFeatures::Detect()))];
+    }
+}
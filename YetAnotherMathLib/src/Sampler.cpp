@@ -0,0 +1,204 @@
+#include "Sampler.h"
+
+#include <array>
+
+namespace YAM{
+    namespace {
+        // Generator matrix of the second Sobol dimension, primitive polynomial x + 1.
+        // Every direction is the previous one xored with itself shifted by one.
+        constexpr std::array<uint32_t, 32> MakeSecondSobolDirections() {
+            std::array<uint32_t, 32> directions{};
+            directions[0] = 1u << 31;
+            for (uint32_t bit = 1; bit < directions.size(); ++bit) {
+                directions[bit] = directions[bit - 1] ^ (directions[bit - 1] >> 1);
+            }
+            return directions;
+        }
+
+        // The matrix product xors one direction per set index bit. Tables of all 256 xors per index
+        // byte replace the 32 step loop, scrambled indices have all 32 bits in use.
+        constexpr std::array<std::array<uint32_t, 256>, 4> MakeSecondSobolTables() {
+            const std::array<uint32_t, 32> directions = MakeSecondSobolDirections();
+
+            std::array<std::array<uint32_t, 256>, 4> tables{};
+            for (uint32_t byte = 0; byte < tables.size(); ++byte) {
+                for (uint32_t value = 0; value < 256; ++value) {
+                    uint32_t result = 0;
+                    for (uint32_t bit = 0; bit < 8; ++bit) {
+                        if (value & (1u << bit)) {
+                            result ^= directions[byte * 8 + bit];
+                        }
+                    }
+                    tables[byte][value] = result;
+                }
+            }
+            return tables;
+        }
+
+        constexpr std::array<std::array<uint32_t, 256>, 4> SecondSobolTables = MakeSecondSobolTables();
+
+        uint32_t ReverseBits(uint32_t value) {
+            value = (value << 16) | (value >> 16);
+            value = ((value & 0x00ff00ffu) << 8) | ((value & 0xff00ff00u) >> 8);
+            value = ((value & 0x0f0f0f0fu) << 4) | ((value & 0xf0f0f0f0u) >> 4);
+            value = ((value & 0x33333333u) << 2) | ((value & 0xccccccccu) >> 2);
+            value = ((value & 0x55555555u) << 1) | ((value & 0xaaaaaaaau) >> 1);
+            return value;
+        }
+
+        // Hash where every bit only depends on the bits below it, so on reversed bits it permutes
+        // the subtrees of each node like Owen scrambling. Constants from Burley 2020.
+        uint32_t LaineKarrasPermutation(uint32_t value, uint32_t seed) {
+            value += seed;
+            value ^= value * 0x6c50b47cu;
+            value ^= value * 0xb82f1e52u;
+            value ^= value * 0xc7afe638u;
+            value ^= value * 0x8d22f6e6u;
+            return value;
+        }
+
+        uint32_t PixelKey(uint32_t seed, uint32_t x, uint32_t y) {
+            return CounterRandom::Pcg(y + CounterRandom::Pcg(x + CounterRandom::Pcg(seed)));
+        }
+    }
+
+    void Sampler::GetDisk(flt& outX, flt& outY) const {
+        flt u, v;
+        Get2D(u, v);
+        SampleWarp::SquareToDisk(u, v, outX, outY);
+    }
+
+    Vector3 Sampler::GetSphereDirection() const {
+        flt u, v;
+        Get2D(u, v);
+        return SampleWarp::SquareToSphere(u, v);
+    }
+
+    Vector3 Sampler::GetCosineHemisphereDirection(const Vector3& normal) const {
+        flt u, v;
+        Get2D(u, v);
+        return SampleWarp::SquareToCosineHemisphere(u, v, normal);
+    }
+
+    RandomSampler::RandomSampler(uint32_t seed)
+        : seed(seed)
+          , random(seed, 0, 0) {}
+
+    std::unique_ptr<Sampler> RandomSampler::Clone() const {
+        return std::make_unique<RandomSampler>(seed);
+    }
+
+    void RandomSampler::StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const {
+        random = CounterRandom(seed, PixelKey(seed, x, y), sampleIndex);
+    }
+
+    flt RandomSampler::Get1D() const {
+        return ToUnitFloat(random.RandInt());
+    }
+
+    void RandomSampler::Get2D(flt& outX, flt& outY) const {
+        outX = ToUnitFloat(random.RandInt());
+        outY = ToUnitFloat(random.RandInt());
+    }
+
+    SobolSampler::SobolSampler(uint32_t seed)
+        : seed(seed)
+          , pixelSeed(0)
+          , sampleIndex(0)
+          , dimension(0) {}
+
+    std::unique_ptr<Sampler> SobolSampler::Clone() const {
+        return std::make_unique<SobolSampler>(seed);
+    }
+
+    void SobolSampler::StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const {
+        pixelSeed = PixelKey(seed, x, y);
+        this->sampleIndex = sampleIndex;
+        dimension = 0;
+    }
+
+    flt SobolSampler::Get1D() const {
+        const uint32_t patternSeed = NextPatternSeed();
+        const uint32_t index = NestedUniformScramble(sampleIndex, patternSeed);
+
+        return ToUnitFloat(ScrambledVanDerCorput(index, CounterRandom::Pcg(patternSeed + 1)));
+    }
+
+    void SobolSampler::Get2D(flt& outX, flt& outY) const {
+        const uint32_t patternSeed = NextPatternSeed();
+        const uint32_t index = NestedUniformScramble(sampleIndex, patternSeed);
+
+        outX = ToUnitFloat(ScrambledVanDerCorput(index, CounterRandom::Pcg(patternSeed + 1)));
+        outY = ToUnitFloat(NestedUniformScramble(Sobol(index, 1), CounterRandom::Pcg(patternSeed + 2)));
+    }
+
+    uint32_t SobolSampler::Sobol(uint32_t index, uint32_t sobolDimension) {
+        // The first dimension is the van der Corput sequence
+        if (sobolDimension == 0) {
+            return ReverseBits(index);
+        }
+
+        return SecondSobolTables[0][index & 0xff] ^ SecondSobolTables[1][(index >> 8) & 0xff]
+            ^ SecondSobolTables[2][(index >> 16) & 0xff] ^ SecondSobolTables[3][index >> 24];
+    }
+
+    uint32_t SobolSampler::NestedUniformScramble(uint32_t value, uint32_t scrambleSeed) {
+        return ReverseBits(LaineKarrasPermutation(ReverseBits(value), scrambleSeed));
+    }
+
+    uint32_t SobolSampler::ScrambledVanDerCorput(uint32_t index, uint32_t scrambleSeed) {
+        // NestedUniformScramble(Sobol(index, 0)) with the two inner bit reversals cancelled
+        return ReverseBits(LaineKarrasPermutation(index, scrambleSeed));
+    }
+
+    uint32_t SobolSampler::NextPatternSeed() const {
+        return CounterRandom::Pcg(pixelSeed ^ CounterRandom::Pcg(dimension++));
+    }
+
+    BlueNoiseSampler::BlueNoiseSampler(const std::shared_ptr<const BlueNoiseMask>& mask, uint32_t seed)
+        : mask(mask)
+          , seed(seed)
+          , pixelX(0)
+          , pixelY(0)
+          , sampleIndex(0)
+          , dimension(0) {}
+
+    std::unique_ptr<Sampler> BlueNoiseSampler::Clone() const {
+        return std::make_unique<BlueNoiseSampler>(mask, seed);
+    }
+
+    void BlueNoiseSampler::StartPixelSample(uint32_t x, uint32_t y, uint32_t sampleIndex) const {
+        pixelX = x;
+        pixelY = y;
+        this->sampleIndex = sampleIndex;
+        dimension = 0;
+    }
+
+    flt BlueNoiseSampler::Get1D() const {
+        // Same for every pixel, only the mask shift below tells pixels apart
+        const uint32_t dimensionKey = CounterRandom::Pcg(seed ^ CounterRandom::Pcg(dimension++));
+        const uint32_t index = SobolSampler::NestedUniformScramble(sampleIndex, dimensionKey);
+
+        const uint32_t value = SobolSampler::NestedUniformScramble(
+            SobolSampler::Sobol(index, 0), CounterRandom::Pcg(dimensionKey + 1));
+        return ToUnitFloat(Shifted(value, dimensionKey, 0));
+    }
+
+    void BlueNoiseSampler::Get2D(flt& outX, flt& outY) const {
+        const uint32_t dimensionKey = CounterRandom::Pcg(seed ^ CounterRandom::Pcg(dimension++));
+        const uint32_t index = SobolSampler::NestedUniformScramble(sampleIndex, dimensionKey);
+
+        const uint32_t valueX = SobolSampler::NestedUniformScramble(
+            SobolSampler::Sobol(index, 0), CounterRandom::Pcg(dimensionKey + 1));
+        const uint32_t valueY = SobolSampler::NestedUniformScramble(
+            SobolSampler::Sobol(index, 1), CounterRandom::Pcg(dimensionKey + 2));
+
+        outX = ToUnitFloat(Shifted(valueX, dimensionKey, 0));
+        outY = ToUnitFloat(Shifted(valueY, dimensionKey, 1));
+    }
+
+    uint32_t BlueNoiseSampler::Shifted(uint32_t value, uint32_t dimensionKey, uint32_t channel) const {
+        // Fixed point addition wraps around exactly like the toroidal shift of the rotation
+        return value + mask->GetOffset(pixelX + (dimensionKey & 0xffff), pixelY + (dimensionKey >> 16), channel);
+    }
+}
@@ -1,6 +0,0 @@
-#include "Vector3.h"
-
-YAM::Vector3::Vector3(const Vector4& vec4)
-    : x(vec4.x)
-      , y(vec4.y)
-      , z(vec4.z) {}
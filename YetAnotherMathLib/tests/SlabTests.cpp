@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "Kernels.h"
+#include "LinearMath.h"
+#include "spdlog/spdlog.h"
+
+namespace {
+    struct SlabCase {
+        const char* name;
+        YAM::Vector3 point;
+        YAM::Vector3 direction;
+        YAM::Vector3 boxMin;
+        YAM::Vector3 boxMax;
+        bool hit;
+    };
+
+    YAM::AABB MakeBox(const YAM::Vector3& min, const YAM::Vector3& max) {
+        YAM::AABB box;
+        box.min = min;
+        box.max = max;
+        return box;
+    }
+
+    // Zero direction components make invDirection infinite, the slab test has to stay exact there.
+    // All cases use the box [5, 6] x [-1, 1] x [0.1, 0.5] unless the ray points to negative x.
+    const YAM::Vector3 BoxMin{5.f, -1.f, 0.1f};
+    const YAM::Vector3 BoxMax{6.f, 1.f, 0.5f};
+
+    const std::vector<SlabCase> Cases = {
+        {"parallel to y and z, inside both slabs", {0.f, 0.1f, 0.25f}, {1.f, 0.f, 0.f}, BoxMin, BoxMax, true},
+        {"parallel to y and z, outside the z slab", {0.f, 0.1f, 0.75f}, {1.f, 0.f, 0.f}, BoxMin, BoxMax, false},
+        {"parallel to x and y, inside both slabs", {5.5f, 0.1f, -3.f}, {0.f, 0.f, 1.f}, BoxMin, BoxMax, true},
+        {"parallel to x and y, outside the x slab", {7.f, 0.1f, -3.f}, {0.f, 0.f, 1.f}, BoxMin, BoxMax, false},
+        {"parallel to x and z, outside the z slab", {5.5f, -3.f, 2.f}, {0.f, 1.f, 0.f}, BoxMin, BoxMax, false},
+        {"lying in the max y plane", {0.f, 1.f, 0.25f}, {1.f, 0.f, 0.f}, BoxMin, BoxMax, true},
+        {"lying in the min z plane", {0.f, 0.f, 0.1f}, {1.f, 0.f, 0.f}, BoxMin, BoxMax, true},
+        {"negative zero components", {0.f, 0.1f, 0.25f}, {-1.f, -0.f, -0.f},
+         {-6.f, -1.f, 0.1f}, {-5.f, 1.f, 0.5f}, true},
+        {"box behind the ray", {0.f, 0.1f, 0.25f}, {-1.f, 0.f, 0.f}, BoxMin, BoxMax, false},
+        {"starting inside", {5.5f, 0.f, 0.25f}, {0.f, 1.f, 0.f}, BoxMin, BoxMax, true},
+        {"diagonal", {0.f, 0.f, 0.f}, {0.6f, 0.f, 0.8f}, {2.5f, -1.f, 3.5f}, {3.5f, 1.f, 4.5f}, true},
+    };
+
+    // Enough boxes per call to fill every vector width plus a remainder
+    constexpr uint32_t BatchSize = 37;
+}
+
+// Slab tests of TraversalRay and of the intersectBoxes kernel of every supported ISA, exits with 1 on any failure
+int main() {
+    uint32_t failures = 0;
+
+    const YAM::IsaLevel detected = YAM::CpuFeatures::Detect();
+    for (const SlabCase& slabCase : Cases) {
+        const YAM::TraversalRay ray(YAM::Ray(slabCase.direction, slabCase.point));
+        const YAM::AABB box = MakeBox(slabCase.boxMin, slabCase.boxMax);
+
+        if (YAM::LinearMath::FindIntersection(ray, box) != slabCase.hit) {
+            spdlog::error("FindIntersection(TraversalRay, AABB), {}: expected {}", slabCase.name, slabCase.hit);
+            ++failures;
+        }
+
+        for (uint8_t level = 0; level <= static_cast<uint8_t>(detected); ++level) {
+            const YAM::KernelTable& kernels = YAM::Kernels::Get(static_cast<YAM::IsaLevel>(level));
+
+            const std::vector<YAM::AABB> boxes(BatchSize, box);
+            std::vector<uint8_t> hits(BatchSize, 2);
+            kernels.intersectBoxes(ray, boxes.data(), BatchSize, hits.data());
+
+            for (const uint8_t hit : hits) {
+                if (static_cast<bool>(hit) != slabCase.hit) {
+                    spdlog::error("intersectBoxes ({}), {}: expected {}",
+                                  YAM::CpuFeatures::ToString(kernels.level), slabCase.name, slabCase.hit);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (failures == 0) {
+        spdlog::info("All {} slab cases passed", Cases.size());
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.h"
+#include "BlueNoise.h"
+#include "spdlog/spdlog.h"
+
+namespace {
+    // Width of the energy filter in texels, Ulichney recommends 1.5
+    constexpr double Sigma = 1.5;
+
+    // Fraction of texels set in the initial binary pattern
+    constexpr double InitialDensity = 0.1;
+
+    // Void and cluster (Ulichney 1993) on a torus, so the mask tiles without seams
+    class VoidAndCluster {
+    private:
+        uint32_t size;
+        uint32_t texelCount;
+
+        // Gaussian of the toroidal distance, indexed by the wrapped offset between two texels
+        std::vector<double> filter;
+
+        std::vector<uint8_t> pattern;
+        std::vector<double> energy;
+
+    public:
+        explicit VoidAndCluster(uint32_t size)
+            : size(size)
+              , texelCount(size * size)
+              , filter(texelCount)
+              , pattern(texelCount, 0)
+              , energy(texelCount, 0.) {
+            for (uint32_t y = 0; y < size; ++y) {
+                for (uint32_t x = 0; x < size; ++x) {
+                    const double dx = std::min(x, size - x);
+                    const double dy = std::min(y, size - y);
+                    filter[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2. * Sigma * Sigma));
+                }
+            }
+        }
+
+        std::vector<uint16_t> Generate(uint32_t seed) {
+            PlaceInitialPattern(seed);
+            Relax();
+
+            const std::vector<uint8_t> prototype = pattern;
+            const std::vector<double> prototypeEnergy = energy;
+            const uint32_t prototypeCount = CountSet();
+
+            std::vector<uint16_t> ranks(texelCount);
+
+            // Phase 1, removing the tightest clusters ranks the prototype texels from the top
+            for (uint32_t rank = prototypeCount; rank > 0; --rank) {
+                const uint32_t cluster = TightestCluster();
+                Toggle(cluster);
+                ranks[cluster] = static_cast<uint16_t>(rank - 1);
+            }
+
+            // Phases 2 and 3, filling the largest voids ranks the rest. With the energy of set texels
+            // the largest void is also the tightest cluster of unset ones, so one loop covers both.
+            pattern = prototype;
+            energy = prototypeEnergy;
+            for (uint32_t rank = prototypeCount; rank < texelCount; ++rank) {
+                const uint32_t gap = LargestVoid();
+                Toggle(gap);
+                ranks[gap] = static_cast<uint16_t>(rank);
+            }
+
+            return ranks;
+        }
+
+    private:
+        void PlaceInitialPattern(uint32_t seed) {
+            const YAM::Random random(seed);
+            const uint32_t initialCount = std::max(1u, static_cast<uint32_t>(texelCount * InitialDensity));
+
+            for (uint32_t placed = 0; placed < initialCount;) {
+                const uint32_t texel = random.RandInt() % texelCount;
+                if (!pattern[texel]) {
+                    Toggle(texel);
+                    ++placed;
+                }
+            }
+        }
+
+        // Moves the tightest cluster into the largest void until that changes nothing
+        void Relax() {
+            for (uint32_t iteration = 0; iteration < texelCount; ++iteration) {
+                const uint32_t cluster = TightestCluster();
+                Toggle(cluster);
+
+                const uint32_t gap = LargestVoid();
+                Toggle(gap);
+
+                if (gap == cluster) {
+                    return;
+                }
+            }
+        }
+
+        void Toggle(uint32_t texel) {
+            pattern[texel] ^= 1;
+            const double sign = pattern[texel] ? 1. : -1.;
+
+            const uint32_t wrap = size - 1;
+            const uint32_t texelX = texel & wrap;
+            const uint32_t texelY = texel / size;
+
+            for (uint32_t y = 0; y < size; ++y) {
+                const uint32_t filterRow = ((y - texelY) & wrap) * size;
+                for (uint32_t x = 0; x < size; ++x) {
+                    energy[y * size + x] += sign * filter[filterRow + ((x - texelX) & wrap)];
+                }
+            }
+        }
+
+        uint32_t TightestCluster() const {
+            uint32_t best = 0;
+            double bestEnergy = -1.;
+            for (uint32_t texel = 0; texel < texelCount; ++texel) {
+                if (pattern[texel] && energy[texel] > bestEnergy) {
+                    best = texel;
+                    bestEnergy = energy[texel];
+                }
+            }
+            return best;
+        }
+
+        uint32_t LargestVoid() const {
+            uint32_t best = 0;
+            double bestEnergy = std::numeric_limits<double>::max();
+            for (uint32_t texel = 0; texel < texelCount; ++texel) {
+                if (!pattern[texel] && energy[texel] < bestEnergy) {
+                    best = texel;
+                    bestEnergy = energy[texel];
+                }
+            }
+            return best;
+        }
+
+        uint32_t CountSet() const {
+            uint32_t count = 0;
+            for (const uint8_t texel : pattern) {
+                count += texel;
+            }
+            return count;
+        }
+    };
+
+    bool ParseArgument(const char* argument, const char* name, const char*& outValue) {
+        const size_t length = std::strlen(name);
+        if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') {
+            return false;
+        }
+
+        outValue = argument + length + 1;
+        return true;
+    }
+}
+
+// yam_bluenoise --out=<file> [--size=<power of two>] [--channels=<n>] [--seed=<n>]
+// The renderer loads res/blueNoise64.bin, made with the defaults.
+int main(int argc, char* argv[]) {
+    uint32_t size = 64;
+    uint32_t channels = 2;
+    uint32_t seed = 0x59414d42u;
+    const char* outPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (ParseArgument(argv[i], "--size", value)) {
+            size = static_cast<uint32_t>(std::atoi(value));
+        }
+        else if (ParseArgument(argv[i], "--channels", value)) {
+            channels = static_cast<uint32_t>(std::atoi(value));
+        }
+        else if (ParseArgument(argv[i], "--seed", value)) {
+            seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        }
+        else if (ParseArgument(argv[i], "--out", value)) {
+            outPath = value;
+        }
+        else {
+            outPath = nullptr;
+            break;
+        }
+    }
+
+    if (!outPath || size < 2 || size > YAM::BlueNoiseMask::MaxSize || !std::has_single_bit(size) || channels == 0) {
+        std::cerr << "Usage: " << argv[0] << " --out=<file> [--size=<power of two, 2 to "
+            << YAM::BlueNoiseMask::MaxSize << ">] [--channels=<n>] [--seed=<n>]\n";
+        return 1;
+    }
+
+    // Channels are independent masks, seeded one after another
+    std::vector<uint16_t> ranks;
+    ranks.reserve(static_cast<size_t>(size) * size * channels);
+    for (uint32_t channel = 0; channel < channels; ++channel) {
+        spdlog::info("Generating channel {} of a {}x{} blue noise mask", channel, size, size);
+
+        VoidAndCluster generator(size);
+        const std::vector<uint16_t> channelRanks = generator.Generate(seed + channel);
+        ranks.insert(ranks.end(), channelRanks.begin(), channelRanks.end());
+    }
+
+    const YAM::BlueNoiseMask mask(size, channels, std::move(ranks));
+    if (!mask.Save(outPath)) {
+        return 1;
+    }
+
+    spdlog::info("Saved blue noise mask to {}", outPath);
+    return 0;
+}